@@ -0,0 +1,120 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+/*
+ *  Dopaminergic modulation laws of the NEST 3.x port, see 
+ *  ../modmodule/da_connection.h.
+ *
+ *  d1_synapse      weight = weight_baseline*(1 + alpha*modulation)
+ *  d2_synapse      weight = weight_baseline*(1 - alpha*modulation)
+ *  d2_div_synapse  weight = weight_baseline/(1 + alpha*modulation)
+ *
+ *  Parameters:
+ *      alpha => amplitude of the modulated change
+ */
+
+#ifndef DA_CONNECTION_H
+#define DA_CONNECTION_H
+
+#include "modulatory_connection.h"
+
+#include "dictutils.h"
+
+namespace mynest
+{
+
+    /*
+    *  Base of the dopaminergic modulation laws, holding the amplitude 
+    *  of the modulation.
+    */
+    class AlphaModulation
+    {
+        protected:
+
+            double alpha;
+
+        public:
+
+            AlphaModulation() 
+                : alpha(1.0)
+            {
+            }
+
+            //! Store the modulation parameters in dictionary
+            void get_status( DictionaryDatum& d ) const
+            {
+                def< double >( d, "alpha", alpha );
+            }
+
+            //! Set the modulation parameters from dictionary
+            void set_status( const DictionaryDatum& d )
+            {
+                updateValue< double >( d, "alpha", alpha );
+            }
+    };
+
+    class D1Modulation : public AlphaModulation
+    {
+        public:
+
+            double compute_modulation( double modulation ) const
+            {
+                return 1.0 + alpha*modulation;
+            }
+    };
+
+    class D2Modulation : public AlphaModulation
+    {
+        public:
+
+            double compute_modulation( double modulation ) const
+            {
+                return 1.0 - alpha*modulation;
+            }
+    };
+
+    class D2DivModulation : public AlphaModulation
+    {
+        public:
+
+            double compute_modulation( double modulation ) const
+            {
+                return 1.0/(1.0 + alpha*modulation);
+            }
+    };
+
+    template < typename targetidentifierT >
+        using D1Connection = ModulatoryConnection< targetidentifierT, D1Modulation >;
+
+    template < typename targetidentifierT >
+        using D2Connection = ModulatoryConnection< targetidentifierT, D2Modulation >;
+
+    template < typename targetidentifierT >
+        using D2DivConnection = ModulatoryConnection< targetidentifierT, D2DivModulation >;
+
+} // namespace mynest
+
+#endif // DA_CONNECTION_H
@@ -0,0 +1,49 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+#include "modmodule.h"
+
+#include "nest_impl.h"
+
+#include "modulatory_connection.h"
+#include "da_connection.h"
+
+// -- Interface to dynamic module loader ---------------------------------------
+
+/*
+ * NEST 3.x finds the module through this object, named after the library.
+ */
+mynest::ModModule modmodule_LTX_module;
+
+void mynest::ModModule::initialize()
+{
+  /* Register the modulatory synapses.
+  */
+  nest::register_connection_model< PlainModulatoryConnection >( "modulatory_synapse" );
+  nest::register_connection_model< D1Connection >( "d1_synapse" );
+  nest::register_connection_model< D2Connection >( "d2_synapse" );
+  nest::register_connection_model< D2DivConnection >( "d2_div_synapse" );
+}
@@ -0,0 +1,55 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+#ifndef MODMODULE_H
+#define MODMODULE_H
+
+#include "nest_extension_interface.h"
+
+namespace mynest
+{
+    /**
+     * Class defining the NEST 3.x module.
+     * Unlike the NEST 2.10 module it defines no SLI functions: NEST 3.x
+     * only needs it to register the synapse models.
+     */
+    class ModModule : public nest::NESTExtensionInterface
+    {
+        public:
+            ModModule()
+            {
+            }
+
+            ~ModModule() override
+            {
+            }
+
+            void initialize() override;
+    };
+
+} // namespace mynest
+
+#endif // MODMODULE_H
@@ -0,0 +1,95 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+#include "modulatory_connection.h"
+
+#include "connector_model.h"
+#include "dictutils.h"
+#include "kernel_manager.h"
+#include "nest_names.h"
+
+namespace mynest
+{
+    //
+    // Implementation of class ModulatoryCommonProperties.
+    //
+
+    ModulatoryCommonProperties::ModulatoryCommonProperties()
+        : nest::CommonSynapseProperties(),
+        vt_( nullptr ),
+        max_modulation_(1)
+    {
+    }
+
+    void ModulatoryCommonProperties::get_status( DictionaryDatum& d ) const
+    {
+        nest::CommonSynapseProperties::get_status( d );
+
+        def< long >( d, nest::names::volume_transmitter, get_vt_node_id() );
+        def< long >( d, "max_modulation", max_modulation_ );
+    }
+
+    void ModulatoryCommonProperties::set_status( const DictionaryDatum& d, 
+            nest::ConnectorModel& cm )
+    {
+        nest::CommonSynapseProperties::set_status( d, cm );
+
+        long max_modulation = max_modulation_;
+        if ( updateValue< long >( d, "max_modulation", max_modulation ) )
+        {
+            if ( max_modulation < 1 )
+                throw nest::BadProperty( "max_modulation must be positive." );
+            max_modulation_ = max_modulation;
+        }
+
+        // "vt" is the name used by the NEST 2.10 module
+        long vt_node_id;
+        if ( updateValue< long >( d, nest::names::volume_transmitter, vt_node_id ) 
+                or updateValue< long >( d, "vt", vt_node_id ) )
+        {
+            const size_t tid = nest::kernel().vp_manager.get_thread_id();
+            nest::Node* vt = nest::kernel().node_manager.get_node_or_proxy( vt_node_id, tid );
+            vt_ = dynamic_cast< nest::volume_transmitter* >( vt );
+
+            if ( vt_ == nullptr )
+                throw nest::BadProperty( "Modulatory source must be "
+                        "volume transmitter" );
+
+            // sums cached for a previous volume transmitter are discarded
+            state_.assign( nest::kernel().vp_manager.get_num_threads(), ModulationState() );
+        }
+    }
+
+    nest::Node* ModulatoryCommonProperties::get_node()
+    {
+        if ( vt_ == nullptr )
+            throw nest::BadProperty( "No volume transmitter has "
+                    "been assigned to the modulatory synapse." );
+        else
+            return vt_;
+    }
+
+} // of namespace mynest
@@ -0,0 +1,331 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+/*
+ *  Port of the modulatory synapses to the connection infrastructure of 
+ *  NEST 3.x (see ../modmodule/modulatory_connection.h for the NEST 2.10 
+ *  version, of which this is the core: per-synapse weights and modulation 
+ *  laws, with the spike sums cached once per thread and trigger).
+ *
+ *  The class ModulatoryConnection implements a generic synapse in which   
+ *  the information from the volume transmitter modulates the amplitude of the weight.
+ *  The *modulation* ( ratio of spikes per delivery interval of the 
+ *  volume transmitter) is passed through the modulation law, which 
+ *  multiplies the baseline weight.
+ *
+ *  Parameters (common to all synapses):
+ *      volume_transmitter => node id of the volume transmitter ("vt" is also accepted)
+ *      max_modulation => max amount of spikes the volume transmitter receives 
+ *
+ *  Parameters (of each synapse):
+ *      weight_baseline =>  the baseline value which has to be multiplied times the *modulation* 
+ *      deliver_interval => deliver interval of the connected volume transmitter
+ */
+
+#ifndef MODULATORY_CONNECTION_H
+#define MODULATORY_CONNECTION_H
+
+#include "connection.h"
+#include "volume_transmitter.h"
+
+#include <vector>
+
+namespace mynest
+{
+
+    /**
+     * Spike sum of the last trigger seen by one thread.
+     * Padded to a cache line so that threads never share one.
+     */
+    struct ModulationState
+    {
+        ModulationState()
+            : t_trig_(-1.0)
+              ,num_spikes_(0.0)
+        {
+        }
+
+        double t_trig_; //!< time of the last trigger, -1 before the first one
+        double num_spikes_; //!< sum of the multiplicities of the modulatory spikes
+
+        char padding_[ 64 - 2*sizeof( double ) ];
+    };
+
+    /**
+     * Class containing the common properties for all synapses of type modulatory connection.
+     */
+    class ModulatoryCommonProperties : public nest::CommonSynapseProperties
+    {
+        public:
+            /**
+             * Default constructor.
+             * Sets all property values to defaults.
+             */
+            ModulatoryCommonProperties();
+
+            /**
+             * Get all properties and put them into a dictionary.
+             */
+            void get_status( DictionaryDatum& d ) const;
+
+            /**
+             * Set properties from the values given in dictionary.
+             */
+            void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm );
+
+            nest::Node* get_node();
+
+            //! Compared by the connectors with the node id of the triggering volume transmitter
+            long get_vt_node_id() const
+            {
+                if ( vt_ != nullptr )
+                    return vt_->get_node_id();
+                else
+                    return -1;
+            }
+
+            /**
+             * Return the ratio of spikes per deliver interval at trigger 
+             * time t_trig on thread t.
+             * The spikes are summed only by the first synapse triggered on the 
+             * thread, all the other synapses read the cached sum. 
+             */
+            double get_modulation( size_t t,
+                    const std::vector< nest::spikecounter >& modulatory_spikes,
+                    double t_trig,
+                    long deliver_interval ) const
+            {
+                ModulationState& state = state_[ t ];
+                if ( state.t_trig_ != t_trig )
+                {
+                    state.num_spikes_ = 0.0;
+                    for ( const auto& sc : modulatory_spikes )
+                        state.num_spikes_ += sc.multiplicity_;
+                    state.t_trig_ = t_trig;
+                }
+
+                // compute the ratio of spikes per deliver_interval between [0,1]
+                return 2*state.num_spikes_/( deliver_interval*max_modulation_ );
+            }
+
+            nest::volume_transmitter* vt_;
+
+            /**
+             * The max amount of spikes that this transmitter receives
+             * (usually the number of neurons in the source population)
+             */ 
+            long max_modulation_;
+
+            //! per-thread spike sums
+            mutable std::vector< ModulationState > state_;
+    };
+
+    /**
+     * Modulation law of the generic modulatory synapse:
+     * the *modulation* directly multiplies the baseline weight.
+     *
+     * As in the NEST 2.10 module, modulation laws are policy classes from 
+     * which ModulatoryConnection inherits, defining compute_modulation(), 
+     * get_status() and set_status() without virtual methods.
+     */
+    class IdentityModulation
+    {
+        public:
+
+            double compute_modulation( double modulation ) const
+            {
+                return modulation;
+            }
+
+            void get_status( DictionaryDatum& ) const
+            {
+            }
+
+            void set_status( const DictionaryDatum& )
+            {
+            }
+    };
+
+    /**
+     * Modulatory connection
+     * A third moduatory neuron can change the 
+     * strength of the weights 
+     *
+     * @tparam modulationT policy giving the modulation law, see IdentityModulation 
+     */
+    template < typename targetidentifierT, typename modulationT >
+        class ModulatoryConnection : public nest::Connection< targetidentifierT >, 
+                                     public modulationT
+    {
+        public:
+            //! Type to use for representing common synapse properties
+            typedef ModulatoryCommonProperties CommonPropertiesType;
+
+            //! Shortcut for base class
+            typedef nest::Connection< targetidentifierT > ConnectionBase;
+
+            //! Type of the events transmitted
+            typedef nest::SpikeEvent EventType;
+
+            static constexpr nest::ConnectionModelProperties properties = 
+                nest::ConnectionModelProperties::HAS_DELAY
+                | nest::ConnectionModelProperties::IS_PRIMARY
+                | nest::ConnectionModelProperties::SUPPORTS_HPC
+                | nest::ConnectionModelProperties::SUPPORTS_LBL
+                | nest::ConnectionModelProperties::REQUIRES_VOLUME_TRANSMITTER;
+
+        private:
+            double weight_baseline; //!< Initial synaptic weight
+            double weight_; //!< Synaptic weight
+            long deliver_interval; //!< deliver interval of the connected volume transmitter
+
+        public:
+
+            /**
+             * Default Constructor.
+             * Sets default values for all parameters. Needed by GenericConnectorModel.
+             */
+            ModulatoryConnection() 
+                : ConnectionBase()
+                  ,modulationT()
+                  ,weight_baseline(1.0)
+                  ,weight_(1.0)
+                  ,deliver_interval(100)
+            {
+            }
+
+            /**
+             * Helper class defining which types of events can be transmitted.
+             * See ../modmodule/modulatory_connection.h.
+             */
+            class ConnTestDummyNode 
+                : public nest::ConnTestDummyNodeBase 
+            {
+                public:
+                    using nest::ConnTestDummyNodeBase::handles_test_event;
+                    size_t handles_test_event( nest::SpikeEvent&, size_t ) override
+                    {
+                        return nest::invalid_port;
+                    }
+            };
+
+            /**
+             * Check that requested connection can be created.
+             * The volume transmitter must be set before the synapses are created.
+             */
+            void check_connection( nest::Node& s,
+                    nest::Node& t,
+                    size_t receptor_type,
+                    const CommonPropertiesType& cp )
+            {
+                if ( cp.vt_ == nullptr )
+                    throw nest::BadProperty( "No volume transmitter has "
+                            "been assigned to the modulatory synapse." );
+
+                ConnTestDummyNode dummy_target;
+                ConnectionBase::check_connection_( dummy_target, s, t, receptor_type );
+            }
+
+            /**
+             * Send an event to the receiver of this connection.
+             * @param e The event to send
+             * @param t Thread
+             * @param cp Common properties to all synapses.
+             */
+            bool send( nest::Event& e, size_t t, const CommonPropertiesType& )
+            {
+                e.set_receiver( *ConnectionBase::get_target( t ) );
+                e.set_weight( weight_ );
+                e.set_delay_steps( ConnectionBase::get_delay_steps() );
+                e.set_rport( ConnectionBase::get_rport() );
+                e(); // this sends the event
+                return true;
+            }
+
+            /**
+             * triggers an update of a synaptic weight
+             * @param t Thread
+             * @param modulatory_spikes counter of modulatory spikes
+             * @param t_trig update triggering time 
+             * @param cp Common properties to all synapses.
+             */
+            void trigger_update_weight( size_t t,
+                    const std::vector< nest::spikecounter >& modulatory_spikes,
+                    double t_trig,
+                    const CommonPropertiesType& cp )
+            {
+                const double modulation = cp.get_modulation( t, modulatory_spikes, t_trig, deliver_interval );
+                weight_ = weight_baseline*modulationT::compute_modulation( modulation );
+            }
+
+            //! Store connection status information in dictionary
+            void get_status( DictionaryDatum& d ) const
+            {
+                ConnectionBase::get_status( d );
+                def< double >( d, nest::names::weight, weight_ );
+                def< double >( d, "weight_baseline", weight_baseline );
+                def< long >( d, "deliver_interval", deliver_interval );
+                modulationT::get_status( d );
+                def< long >( d, nest::names::size_of, sizeof( *this ) );
+            }
+
+            /**
+             * Set connection status.
+             *
+             * @param d Dictionary with new parameter values
+             * @param cm ConnectorModel is passed along to validate new delay values
+             */
+            void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm )
+            {
+                ConnectionBase::set_status( d, cm );
+                updateValue< double >( d, nest::names::weight, weight_ );
+                updateValue< double >( d, "weight_baseline", weight_baseline );
+                updateValue< long >( d, "deliver_interval", deliver_interval );
+                if ( deliver_interval < 1 )
+                    throw nest::BadProperty( "deliver_interval must be positive." );
+                modulationT::set_status( d );
+            }
+
+            //! Allows efficient initialization on contstruction
+            void set_weight( double w )
+            {
+                weight_ = w;
+            }
+    };
+
+    template < typename targetidentifierT, typename modulationT >
+        constexpr nest::ConnectionModelProperties ModulatoryConnection< targetidentifierT, modulationT >::properties;
+
+    /*
+    *  The generic modulatory synapse, weight = weight_baseline*modulation.
+    *  NEST 3.x registers templates with a single parameter, the target identifier.
+    */
+    template < typename targetidentifierT >
+        using PlainModulatoryConnection = ModulatoryConnection< targetidentifierT, IdentityModulation >;
+
+} // namespace mynest
+
+#endif // MODULATORY_CONNECTION_H
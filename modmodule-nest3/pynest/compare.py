@@ -0,0 +1,196 @@
+#----------------------------------------------------------
+# compare.py
+#
+# Runs the same deterministic network with the NEST 2.10 and
+# the NEST 3.x builds of modmodule, one installation at a 
+# time, then compares the runs:
+#
+#   (NEST 2.10 environment) python compare.py --run nest2
+#   (NEST 3.x environment)  python compare.py --run nest3
+#   python compare.py --compare nest2 nest3
+#
+# --compare exits with 1 if the runs sampled different synapses
+# or times, or if a weight differs by more than --tolerance, so
+# that it can be run as a test (see CMakeLists.txt).
+#
+# Modulatory and presynaptic spikes come from spike_generators
+# with fixed times and the populations are connected all to all,
+# so the weights do not depend on the random generators of the
+# two kernels. Each run writes the weight of
+# every synapse at each sample time to <run>_weights.csv and
+# its build time, Simulate time, memory and size_of to 
+# <run>_summary.csv.
+#----------------------------------------------------------
+
+from __future__ import print_function
+
+import argparse
+import csv
+import sys
+import time
+
+import numpy as np
+
+MODELS = ["modulatory_synapse", "d1_synapse", "d2_synapse", "d2_div_synapse"]
+
+SUMMARY_FIELDS = ["nest", "model", "synapses", "build_time", 
+        "simulate_time", "memory", "size_of"]
+
+######################################################################################################
+######################################################################################################
+######################################################################################################
+
+def parse_args() :
+    parser = argparse.ArgumentParser(description="Compare the NEST 2.10 and 3.x builds of modmodule")
+    parser.add_argument("--run", help="name of the run, prefix of the files written")
+    parser.add_argument("--compare", nargs=2, metavar=("RUN_A", "RUN_B"),
+            help="compare two runs written before")
+    parser.add_argument("--neurons", type=int, default=300,
+            help="neurons in the pre and in the post population, connected all to all")
+    parser.add_argument("--mod-neurons", type=int, default=100,
+            help="modulatory neurons")
+    parser.add_argument("--deliver-interval", type=int, default=10,
+            help="deliver interval of the volume transmitter (min_delay)")
+    parser.add_argument("--threads", type=int, default=1,
+            help="local_num_threads")
+    parser.add_argument("--stime", type=float, default=1000.0,
+            help="simulated time (ms)")
+    parser.add_argument("--sample", type=float, default=100.0,
+            help="interval between two samples of the weights (ms)")
+    parser.add_argument("--tolerance", type=float, default=1e-9,
+            help="largest difference of weights accepted by --compare")
+    return parser.parse_args()
+
+######################################################################################################
+######################################################################################################
+######################################################################################################
+
+def spike_times(n, rate, stime, seed) :
+    """ Poisson spike times (ms) of n trains, on the 0.1 ms grid """
+    rng = np.random.RandomState(seed)
+    trains = []
+    for i in range(n) :
+        k = rng.poisson(rate*stime/1000.0)
+        t = np.unique(np.round(rng.uniform(1.0, stime, k), 1))
+        trains.append(t.tolist())
+    return trains
+
+def run(args) :
+    import nest
+
+    nest3 = hasattr(nest, "__version__") and nest.__version__.startswith("3")
+    sli_func = nest.ll_api.sli_func if nest3 else nest.sli_func
+    model_key = "synapse_model" if nest3 else "model"
+
+    # install the module, it stays loaded across ResetKernel
+    try :
+        nest.Install("modmodule")
+    except nest.NESTError :
+        pass
+
+    results = []
+    weights = []
+    for model in MODELS :
+        nest.ResetKernel()
+        nest.SetKernelStatus({"local_num_threads" : args.threads, "resolution" : 0.1})
+
+        memory_start = sli_func("memory_thisjob")
+        start = time.time()
+
+        # parrots replay the fixed spike trains
+        pre_gen = nest.Create("spike_generator", args.neurons)
+        mod_gen = nest.Create("spike_generator", args.mod_neurons)
+        pre_times = spike_times(args.neurons, 10.0, args.stime, 1)
+        mod_times = spike_times(args.mod_neurons, 20.0, args.stime, 2)
+        nest.SetStatus(pre_gen, [{"spike_times" : t} for t in pre_times])
+        nest.SetStatus(mod_gen, [{"spike_times" : t} for t in mod_times])
+
+        neurons_pre = nest.Create("parrot_neuron", args.neurons)
+        neurons_mod = nest.Create("parrot_neuron", args.mod_neurons)
+        neurons_post = nest.Create("iaf_psc_exp", args.neurons)
+        nest.Connect(pre_gen, neurons_pre, "one_to_one")
+        nest.Connect(mod_gen, neurons_mod, "one_to_one")
+
+        vt = nest.Create("volume_transmitter")
+        nest.SetStatus(vt, {"deliver_interval" : args.deliver_interval})
+        vt_id = vt.tolist()[0] if nest3 else vt[0]
+        nest.Connect(neurons_mod, vt)
+
+        # both builds accept "vt" 
+        params = {"vt" : vt_id, "max_modulation" : args.mod_neurons}
+        nest.CopyModel(model, "compared_synapse", params)
+        nest.Connect(neurons_pre, neurons_post, 
+                {"rule" : "all_to_all"}, 
+                {model_key : "compared_synapse", "alpha" : 0.5} if model != "modulatory_synapse" 
+                else {model_key : "compared_synapse"})
+        build_time = time.time() - start
+
+        conns = nest.GetConnections(synapse_model="compared_synapse")
+        sources = np.array(nest.GetStatus(conns, "source"))
+        targets = np.array(nest.GetStatus(conns, "target"))
+        order = np.lexsort((targets, sources))
+
+        simulate_time = 0.0
+        t = 0.0
+        while t < args.stime :
+            start = time.time()
+            nest.Simulate(args.sample)
+            simulate_time += time.time() - start
+            t += args.sample
+            w = np.array(nest.GetStatus(conns, "weight"))[order]
+            weights.extend([[model, t, i, wi] for i, wi in enumerate(w)])
+
+        results.append({"nest" : "3" if nest3 else "2.10", 
+                "model" : model, 
+                "synapses" : len(conns),
+                "build_time" : build_time,
+                "simulate_time" : simulate_time,
+                "memory" : sli_func("memory_thisjob") - memory_start,
+                "size_of" : nest.GetStatus(conns[:1], "size_of")[0]})
+        print(results[-1])
+
+    with open(args.run + "_summary.csv", "w") as f :
+        writer = csv.DictWriter(f, fieldnames=SUMMARY_FIELDS)
+        writer.writeheader()
+        writer.writerows(results)
+    with open(args.run + "_weights.csv", "w") as f :
+        writer = csv.writer(f)
+        writer.writerow(["model", "time", "synapse", "weight"])
+        writer.writerows(weights)
+
+def compare(run_a, run_b, tolerance) :
+    def load_weights(run) :
+        with open(run + "_weights.csv") as f :
+            return dict(((r["model"], float(r["time"]), int(r["synapse"])), float(r["weight"])) 
+                    for r in csv.DictReader(f))
+    def load_summary(run) :
+        with open(run + "_summary.csv") as f :
+            return dict((r["model"], r) for r in csv.DictReader(f))
+
+    weights_a, weights_b = load_weights(run_a), load_weights(run_b)
+    summary_a, summary_b = load_summary(run_a), load_summary(run_b)
+    same = True
+    if set(weights_a) != set(weights_b) :
+        print("the runs sampled different synapses or times")
+        same = False
+
+    print("%-16s %12s %12s %12s %12s %12s" % ("model", "max |dw|", 
+        "sim " + run_a, "sim " + run_b, "mem " + run_a, "mem " + run_b))
+    for model in MODELS :
+        keys = [k for k in weights_a if k[0] == model and k in weights_b]
+        dw = max([abs(weights_a[k] - weights_b[k]) for k in keys] or [float("nan")])
+        if not dw <= tolerance :
+            same = False
+        print("%-16s %12g %12s %12s %12s %12s" % (model, dw, 
+            summary_a[model]["simulate_time"][:8], summary_b[model]["simulate_time"][:8],
+            summary_a[model]["memory"], summary_b[model]["memory"]))
+    return same
+
+if __name__ == "__main__" :
+    args = parse_args()
+    if args.compare :
+        sys.exit(0 if compare(args.compare[0], args.compare[1], args.tolerance) else 1)
+    elif args.run :
+        run(args)
+    else :
+        print("use --run NAME or --compare RUN_A RUN_B")
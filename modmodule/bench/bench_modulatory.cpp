@@ -0,0 +1,269 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+/*
+ *  Microbenchmark of the trigger and send paths of the modulatory synapses,
+ *  built against the stand-ins in bench/standins instead of NEST:
+ *
+ *      cd modmodule
+ *      g++ -O3 -march=native -std=c++11 -fopenmp -Ibench/standins -I. \
+ *          bench/bench_modulatory.cpp modulatory_connection.cpp modulation_recorder.cpp \
+ *          -o bench_modulatory
+ *      ./bench_modulatory [n_synapses ...]
+ *
+ *  For each model and number of synapses (10^5, 10^6 and 10^7 by default)
+ *  it reports the bytes per synapse and the ns per synapse of a trigger 
+ *  through trigger_update_weight() one synapse at a time, as the NEST 
+ *  connectors do, and of send().
+ *  The modulation changes at every trigger, so that no weight update is skipped.
+ *
+ *  Each run then checks the weight delivered by every synapse against the
+ *  modulation law, once after the timed triggers and once more with 
+ *  lazy_weight, where the weight is computed by send(). The benchmark 
+ *  exits with 1 if any synapse is off.
+ */
+
+#include "modulatory_connection.h"
+#include "da_connection.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /**
+     * Target of the benchmarked synapses, summing the weights it receives
+     * so that the compiler can not drop the deliveries.
+     */
+    class BenchNode : public nest::Node
+    {
+        public:
+            BenchNode()
+                : sum_( 0.0 )
+            {
+            }
+
+            void handle( nest::SpikeEvent& e )
+            {
+                sum_ += e.get_weight();
+            }
+
+            nest::double_t sum_;
+    };
+
+    const int num_triggers = 10;
+    const nest::long_t max_modulation = 100;
+    const nest::long_t deliver_interval = 100; //!< default of the synapses
+
+    //! Modulation law with alpha 1, the weight of a synapse with baseline 1
+    typedef nest::double_t ( *Law )( nest::double_t modulation );
+
+    //! Number of modulatory spikes of trigger k, a different count each time
+    int get_num_spikes( int k )
+    {
+        return 1 + k % max_modulation;
+    }
+
+    std::vector< nest::spikecounter > get_spikes( int k, nest::double_t t_trig )
+    {
+        std::vector< nest::spikecounter > spikes;
+        for ( int i = 0; i < get_num_spikes( k ); ++i )
+            spikes.push_back( nest::spikecounter( t_trig - 1.0, 1.0 ) );
+        return spikes;
+    }
+
+    //! Modulation the synapses must see at trigger k, as a ratio of spikes per interval
+    nest::double_t get_modulation( int k )
+    {
+        return 2.0*get_num_spikes( k )/( deliver_interval*max_modulation );
+    }
+
+    /**
+     * Target checking the weight of each spike it receives against the 
+     * expected one, with a tolerance that covers the float variants.
+     */
+    class CheckNode : public nest::Node
+    {
+        public:
+            explicit CheckNode( nest::double_t expected )
+                : expected_( expected ),
+                spikes_( 0 ),
+                errors_( 0 ),
+                worst_( expected )
+            {
+            }
+
+            void handle( nest::SpikeEvent& e )
+            {
+                ++spikes_;
+                if ( std::abs( e.get_weight() - expected_ ) > 1e-6*( 1.0 + std::abs( expected_ ) ) )
+                {
+                    if ( errors_ == 0 or std::abs( e.get_weight() - expected_ ) > std::abs( worst_ - expected_ ) )
+                        worst_ = e.get_weight();
+                    ++errors_;
+                }
+            }
+
+            nest::double_t expected_;
+            size_t spikes_;
+            size_t errors_;
+            nest::double_t worst_; //!< delivered weight furthest from the expected one
+    };
+
+    /**
+     * Send one spike through each synapse to a CheckNode and report the 
+     * synapses whose weight is not the expected one. True if all are.
+     */
+    template < typename ConnectionT >
+        bool check( const char* name, const char* path, 
+                std::vector< ConnectionT >& synapses, 
+                const typename ConnectionT::CommonPropertiesType& cp,
+                nest::double_t expected )
+        {
+            BenchNode source;
+            CheckNode target( expected );
+            nest::SpikeEvent e;
+            for ( auto & synapse: synapses )
+            {
+                synapse.check_connection( source, target, 0, 0.0, cp );
+                synapse.send( e, 0, 0.0, cp );
+            }
+
+            if ( target.spikes_ == synapses.size() and target.errors_ == 0 )
+                return true;
+
+            std::fprintf( stderr, "%s, %s: %zu of %zu synapses delivered a wrong weight "
+                    "(%zu spikes, expected %.9g, got %.9g)\n", name, path, 
+                    target.errors_, synapses.size(), target.spikes_, expected, target.worst_ );
+            return false;
+        }
+
+    template < typename F >
+        double time_ns( F f )
+        {
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            f();
+            return std::chrono::duration< double, std::nano >( 
+                    std::chrono::steady_clock::now() - start ).count();
+        }
+
+    template < typename ConnectionT >
+        bool bench( const char* name, size_t n, Law law )
+        {
+            typedef typename ConnectionT::CommonPropertiesType CommonPropertiesType;
+
+            // a model bound to a volume transmitter of its own, on one thread
+            static nest::long_t vt_gid = 0;
+            nest::GenericConnectorModel< ConnectionT > model;
+            CommonPropertiesType& cp = model.cp_;
+            cp.max_modulation_ = max_modulation;
+            cp.cache_ = mynest::ModulationCache::get_cache( ++vt_gid );
+            cp.cache_->reset( 1 );
+            cp.state_.assign( 1, mynest::ModulationState() );
+
+            BenchNode source;
+            BenchNode target;
+            std::vector< ConnectionT > synapses( n );
+            for ( size_t i = 0; i < n; ++i )
+                synapses[ i ].check_connection( source, target, 0, 0.0, cp );
+
+            nest::double_t t_trig = 0.0;
+            const double trigger_ns = time_ns( [&]() {
+                    for ( int k = 0; k < num_triggers; ++k )
+                    {
+                        t_trig += 100.0;
+                        const std::vector< nest::spikecounter > spikes = get_spikes( k, t_trig );
+                        for ( size_t i = 0; i < n; ++i )
+                            synapses[ i ].trigger_update_weight( 0, spikes, t_trig, cp );
+                    }
+                } );
+
+            nest::SpikeEvent e;
+            const double send_ns = time_ns( [&]() {
+                    for ( size_t i = 0; i < n; ++i )
+                        synapses[ i ].send( e, 0, 0.0, cp );
+                } );
+
+            std::printf( "%-16s %12zu %10zu %12.3f %12.3f %14.6g\n", name, n, 
+                    sizeof( ConnectionT ),
+                    trigger_ns/( num_triggers*n ),
+                    send_ns/n,
+                    target.sum_/n );
+
+            // per-synapse trigger path: the weights of the last timed trigger
+            bool ok = check( name, "trigger", synapses, cp, law( get_modulation( num_triggers - 1 ) ) );
+
+            // lazy path: the trigger only updates the modulation, send() the weight
+            cp.lazy_weight_ = true;
+            t_trig += 100.0;
+            const std::vector< nest::spikecounter > spikes = get_spikes( num_triggers, t_trig );
+            for ( size_t i = 0; i < n; ++i )
+                synapses[ i ].trigger_update_weight( 0, spikes, t_trig, cp );
+            ok = check( name, "lazy", synapses, cp, law( get_modulation( num_triggers ) ) ) and ok;
+
+            return ok;
+        }
+}
+
+int main( int argc, char** argv )
+{
+    std::vector< size_t > sizes;
+    for ( int i = 1; i < argc; ++i )
+        sizes.push_back( std::strtoul( argv[ i ], 0, 10 ) );
+    if ( sizes.empty() )
+        sizes = { 100000, 1000000, 10000000 };
+
+    std::printf( "%-16s %12s %10s %12s %12s %14s\n", "model", "synapses", 
+            "bytes/syn", "trigger_ns", "send_ns", "mean_weight" );
+
+    // the laws of da_connection.h with alpha 1
+    const Law identity = []( nest::double_t m ) { return m; };
+    const Law d1 = []( nest::double_t m ) { return 1.0 + m; };
+    const Law d2 = []( nest::double_t m ) { return 1.0 - m; };
+    const Law d2_div = []( nest::double_t m ) { return 1.0/( 1.0 + m ); };
+
+    bool ok = true;
+    for ( size_t n: sizes )
+    {
+        if ( n == 0 )
+            continue;
+
+        ok = bench< mynest::ModulatoryConnection< nest::TargetIdentifierPtrRport > >( "modulatory", n, identity ) and ok;
+        ok = bench< mynest::D1Connection< nest::TargetIdentifierPtrRport > >( "d1", n, d1 ) and ok;
+        ok = bench< mynest::D2Connection< nest::TargetIdentifierPtrRport > >( "d2", n, d2 ) and ok;
+        ok = bench< mynest::D2DivConnection< nest::TargetIdentifierPtrRport > >( "d2_div", n, d2_div ) and ok;
+        ok = bench< mynest::ModulatoryHPCConnection< nest::TargetIdentifierIndex > >( "modulatory_hpc", n, identity ) and ok;
+        ok = bench< mynest::D1HPCConnection< nest::TargetIdentifierIndex > >( "d1_hpc", n, d1 ) and ok;
+        ok = bench< mynest::D2HPCConnection< nest::TargetIdentifierIndex > >( "d2_hpc", n, d2 ) and ok;
+        ok = bench< mynest::D2DivHPCConnection< nest::TargetIdentifierIndex > >( "d2_div_hpc", n, d2_div ) and ok;
+    }
+
+    return ok ? 0 : 1;
+}
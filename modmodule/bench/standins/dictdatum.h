@@ -0,0 +1,2 @@
+// stand-in, see nest_standins.h
+#include "nest_standins.h"
@@ -0,0 +1,346 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+/*
+ *  Minimal stand-ins for the parts of NEST 2.10 used by the synapse classes
+ *  of modmodule, enough to compile them and to run their trigger and send 
+ *  paths without a NEST installation.
+ *
+ *  Only the classes touched on the hot paths behave like NEST: Connection
+ *  stores its target and delay, Event delivers itself to the handle() of
+ *  its receiver through a virtual call, and spikecounter is the same 
+ *  plain struct. Dictionaries and the network are inert.
+ */
+
+#ifndef NEST_STANDINS_H
+#define NEST_STANDINS_H
+
+#include <cmath>
+#include <cstddef>
+#include <exception>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+// -- SLI ----------------------------------------------------------------------
+
+class Datum
+{
+public:
+  virtual ~Datum() {}
+};
+
+class Token
+{
+public:
+  Token() {}
+  template < class T > Token( const T& ) {}
+  bool empty() const { return true; }
+  operator long() const { return 0; }
+  Datum* datum() const { return 0; }
+};
+
+struct Name
+{
+  Name( const char* s ) : s_( s ) {}
+  Name( const std::string& s ) : s_( s ) {}
+  std::string toString() const { return s_; }
+  bool operator<( const Name& n ) const { return s_ < n.s_; }
+  std::string s_;
+};
+
+class Dictionary : public std::map< Name, Token >
+{
+public:
+  bool known( const Name& ) const { return false; }
+};
+
+class DictionaryDatum
+{
+public:
+  DictionaryDatum() : d_( new Dictionary ) {}
+  explicit DictionaryDatum( Dictionary* d ) : d_( d ) {}
+  Dictionary* operator->() const { return d_; }
+private:
+  Dictionary* d_; // leaked, the stand-ins never use dictionaries on hot paths
+};
+
+class TokenArray
+{
+public:
+  size_t size() const { return 0; }
+  const Token& operator[]( size_t ) const { static Token t; return t; }
+  void push_back( const Token& ) {}
+  void push_back( Datum* d ) { delete d; }
+};
+
+class ArrayDatum : public TokenArray {};
+
+class StringDatum : public Datum, public std::string
+{
+public:
+  StringDatum() {}
+  StringDatum( const std::string& s ) : std::string( s ) {}
+};
+
+template < typename T > void def( DictionaryDatum&, Name, const T& ) {}
+template < typename T, typename U > bool updateValue( const DictionaryDatum&, Name, U& ) { return false; }
+template < typename T > T getValue( const DictionaryDatum&, Name ) { return T(); }
+template < typename T > T getValue( const Token& ) { return T(); }
+
+class SLIInterpreter;
+
+// -- nestkernel ---------------------------------------------------------------
+
+namespace nest
+{
+typedef double double_t;
+typedef long long_t;
+typedef unsigned long index;
+typedef int thread;
+typedef long port;
+typedef long rport;
+typedef unsigned int synindex;
+
+const port invalid_port_ = -1;
+
+namespace names
+{
+static const Name weight( "weight" );
+static const Name size_of( "size_of" );
+static const Name synapse_model( "synapse_model" );
+}
+
+class KernelException : public std::exception
+{
+public:
+  KernelException() {}
+  KernelException( const std::string& ) {}
+};
+
+class BadProperty : public KernelException
+{
+public:
+  BadProperty( const std::string& s ) : KernelException( s ) {}
+};
+
+class Time
+{
+public:
+  double get_ms() const { return 0; }
+};
+
+class Communicator
+{
+public:
+  static int get_num_processes() { return 1; }
+  static int get_rank() { return 0; }
+};
+
+struct spikecounter
+{
+  spikecounter( double_t spike_time, double_t multiplicity )
+    : spike_time_( spike_time ), multiplicity_( multiplicity ) {}
+  double_t spike_time_;
+  double_t multiplicity_;
+};
+
+class Event;
+class SpikeEvent;
+
+class Node
+{
+public:
+  Node() : gid_( 0 ) {}
+  virtual ~Node() {}
+  index get_gid() const { return gid_; }
+  void set_gid( index gid ) { gid_ = gid; }
+  virtual bool has_proxies() const { return true; }
+  virtual bool one_node_per_process() const { return false; }
+  virtual void get_status( DictionaryDatum& ) const {}
+  virtual void set_status( const DictionaryDatum& ) {}
+  virtual port handles_test_event( SpikeEvent&, rport ) { return invalid_port_; }
+  virtual void handle( SpikeEvent& ) {}
+  virtual void finalize() {}
+protected:
+  virtual void init_state_( const Node& ) {}
+  virtual void init_buffers_() {}
+  virtual void calibrate() {}
+  virtual void update( Time const&, const long_t, const long_t ) {}
+private:
+  index gid_;
+};
+
+class Event
+{
+public:
+  Event() : receiver_( 0 ), weight_( 0 ), delay_( 0 ), rport_( 0 ) {}
+  virtual ~Event() {}
+  void set_weight( double_t w ) { weight_ = w; }
+  double_t get_weight() const { return weight_; }
+  void set_delay( long_t d ) { delay_ = d; }
+  void set_receiver( Node& r ) { receiver_ = &r; }
+  void set_rport( rport p ) { rport_ = p; }
+  rport get_rport() const { return rport_; }
+  virtual void operator()() = 0;
+protected:
+  Node* receiver_;
+  double_t weight_;
+  long_t delay_;
+  rport rport_;
+};
+
+class SpikeEvent : public Event
+{
+public:
+  void operator()() { receiver_->handle( *this ); }
+};
+
+class volume_transmitter : public Node {};
+
+class ConnTestDummyNodeBase : public Node {};
+
+class ConnectorModel;
+
+class CommonSynapseProperties
+{
+public:
+  virtual ~CommonSynapseProperties() {}
+  void get_status( DictionaryDatum& ) const {}
+  void set_status( const DictionaryDatum&, ConnectorModel& ) {}
+};
+
+class ConnectorModel
+{
+public:
+  virtual ~ConnectorModel() {}
+  virtual const CommonSynapseProperties& get_common_properties() const = 0;
+  std::string get_name() const { return "standin"; }
+};
+
+template < class ConnectionT >
+class GenericConnectorModel : public ConnectorModel
+{
+public:
+  const CommonSynapseProperties& get_common_properties() const { return cp_; }
+  typename ConnectionT::CommonPropertiesType cp_;
+};
+
+//! Target stored as a pointer, as in NEST
+class TargetIdentifierPtrRport
+{
+public:
+  TargetIdentifierPtrRport() : target_( 0 ), rport_( 0 ) {}
+  void set_target( Node* t ) { target_ = t; }
+  Node* get_target_ptr( thread ) const { return target_; }
+  rport get_rport() const { return rport_; }
+  void set_rport( rport r ) { rport_ = r; }
+private:
+  Node* target_;
+  rport rport_;
+};
+
+//! Target stored as a 16 bit index in a table of nodes, as in NEST
+class TargetIdentifierIndex
+{
+public:
+  TargetIdentifierIndex() : target_( 0 ) {}
+  void set_target( Node* t )
+  {
+    std::vector< Node* >& table = nodes();
+    size_t i = 0;
+    while ( i < table.size() && table[ i ] != t )
+      ++i;
+    if ( i == table.size() )
+      table.push_back( t );
+    target_ = i;
+  }
+  Node* get_target_ptr( thread ) const { return nodes()[ target_ ]; }
+  rport get_rport() const { return 0; }
+  void set_rport( rport ) {}
+  static std::vector< Node* >& nodes()
+  {
+    static std::vector< Node* > nodes_;
+    return nodes_;
+  }
+private:
+  unsigned short target_;
+};
+
+template < typename targetidentifierT >
+class Connection
+{
+public:
+  Connection() : delay_( 1 ), syn_id_( 0 ) {}
+  void get_status( DictionaryDatum& ) const {}
+  void set_status( const DictionaryDatum&, ConnectorModel& ) {}
+  long_t get_delay_steps() const { return delay_; }
+  Node* get_target( thread t ) const { return target_.get_target_ptr( t ); }
+  rport get_rport() const { return target_.get_rport(); }
+  synindex get_syn_id() const { return syn_id_; }
+protected:
+  void check_connection_( Node&, Node&, Node& t, rport receptor_type )
+  {
+    target_.set_target( &t );
+    target_.set_rport( receptor_type );
+  }
+  targetidentifierT target_;
+  // delay and syn_id share 32 bits in NEST
+  unsigned int delay_ : 21;
+  unsigned int syn_id_ : 11;
+};
+
+class Network
+{
+public:
+  Node* get_node( index, thread = 0 ) { return 0; }
+  thread get_num_threads() const { return 1; }
+  const ConnectorModel& get_synapse_prototype( synindex, thread = 0 ) const
+  {
+    struct Prototype : ConnectorModel
+    {
+      const CommonSynapseProperties& get_common_properties() const { return cp_; }
+      CommonSynapseProperties cp_;
+    };
+    static Prototype prototype;
+    return prototype;
+  }
+};
+
+class NestModule
+{
+public:
+  static Network& get_network()
+  {
+    static Network network;
+    return network;
+  }
+};
+
+} // namespace nest
+
+#endif // NEST_STANDINS_H
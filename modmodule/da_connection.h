@@ -40,153 +40,126 @@ namespace mynest
 {
 
     /*
-    *  The class D1Connection implements a dopaminergic synapse in which   
-    *  the information from the volume transmitter modulates the amplitude of the weight as
-    *  in D1R synapses in the model by Humphries et al. 2006 (http://dx.doi.org/10.1523/JNEUROSCI.3486-06.2006).
-    *  
-    *  weight = initial_weight*(1 + alpha*modulation)
+    *  Base of the dopaminergic modulation laws, holding the amplitude 
+    *  of the modulation.
     *
     *  Parameters:
-    *      initial_weight =>  the baseline value which has to be multiplied times the *modulation* 
-    *      alpha => amplitude of the modulated increment
+    *      alpha => amplitude of the modulated change
     */
-
-    template < typename targetidentifierT >
-        class D1Connection : public ModulatoryConnection< targetidentifierT >
+    template < typename valueT >
+    class AlphaModulation
     {
-        private:
-            
-            nest::double_t alpha;
+        protected:
+
+            valueT alpha;
 
         public:
-            
-                //! Shortcut for base class
-            typedef ModulatoryConnection< targetidentifierT > ConnectionBase;
 
+            typedef valueT value_type;
 
-            D1Connection() 
-                : ConnectionBase(), alpha(1.0)
+            AlphaModulation() 
+                : alpha(1.0)
             {
             }
 
-            // The following methods contain mostly fixed code to forward the corresponding
-            // tasks to corresponding methods in the base class and the w_ data member holding
-            // the weight.
-
-            //! Store connection status information in dictionary
-            void get_status( DictionaryDatum& d ) const;
+            //! Store the modulation parameters in dictionary
+            void get_status( DictionaryDatum& d ) const
+            {
+                def< nest::double_t >( d, "alpha", alpha );
+            }
 
-            /**
-             * Set connection status.
-             *
-             * @param d Dictionary with new parameter values
-             * @param cm ConnectorModel is passed along to validate new delay values
-             */
-            void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm );
+            //! Set the modulation parameters from dictionary
+            void set_status( const DictionaryDatum& d )
+            {
+                updateValue< nest::double_t >( d, "alpha", alpha );
+            }
 
             //! Allows efficient initialization on contstruction
             void  set_alpha( nest::double_t alpha_ )
             {
                 alpha = alpha_;
             }
+    };
 
-            virtual nest::double_t compute_modulation(nest::double_t modulation)
+    /*
+    *  Modulation law of D1R synapses in the model by 
+    *  Humphries et al. 2006 (http://dx.doi.org/10.1523/JNEUROSCI.3486-06.2006).
+    *  
+    *  weight = initial_weight*(1 + alpha*modulation)
+    */
+    template < typename valueT = nest::double_t >
+    class D1Modulation : public AlphaModulation< valueT >
+    {
+        public:
+
+            nest::double_t compute_modulation( nest::double_t modulation ) const
             {
-                return 1.0 + alpha*modulation;
+                return 1.0 + this->alpha*modulation;
             }
     };
 
-
-    template < typename targetidentifierT >
-        void D1Connection< targetidentifierT >::get_status( DictionaryDatum& d ) const
-        {
-            ConnectionBase::get_status( d );
-            def< nest::double_t >( d, "alpha", alpha );
-            def< nest::long_t >( d, nest::names::size_of, sizeof( *this ) );
-        }
-
-    template < typename targetidentifierT >
-        void D1Connection< targetidentifierT >::set_status( const DictionaryDatum& d,
-                nest::ConnectorModel& cm )
-        {
-            ConnectionBase::set_status( d, cm );
-            updateValue< nest::double_t >( d, "alpha", alpha );
-        }
-
-
     /*
-    *  The class D2Connection implements a dopaminergic synapse in which   
-    *  the information from the volume transmitter modulates the amplitude of the weight as
-    *  in D2R synapses in the model by Humphries et al. 2006 (http://dx.doi.org/10.1523/JNEUROSCI.3486-06.2006).
+    *  Modulation law of D2R synapses in the model by 
+    *  Humphries et al. 2006 (http://dx.doi.org/10.1523/JNEUROSCI.3486-06.2006).
     *  
     *  weight = initial_weight*(1 - alpha*modulation)
-    *
-    *  Parameters:
-    *      initial_weight =>  the baseline value which has to be multiplied times the *modulation* 
-    *      alpha => amplitude of the modulated decrease
     */
-    template < typename targetidentifierT >
-        class D2Connection : public ModulatoryConnection< targetidentifierT >
+    template < typename valueT = nest::double_t >
+    class D2Modulation : public AlphaModulation< valueT >
     {
-        private:
-            
-            nest::double_t alpha;
-
         public:
-            
-                //! Shortcut for base class
-            typedef ModulatoryConnection< targetidentifierT > ConnectionBase;
-
 
-            D2Connection() 
-                : ConnectionBase(), alpha(1.0)
+            nest::double_t compute_modulation( nest::double_t modulation ) const
             {
+                return 1.0 - this->alpha*modulation;
             }
+    };
 
-            // The following methods contain mostly fixed code to forward the corresponding
-            // tasks to corresponding methods in the base class and the w_ data member holding
-            // the weight.
-
-            //! Store connection status information in dictionary
-            void get_status( DictionaryDatum& d ) const;
-
-            /**
-             * Set connection status.
-             *
-             * @param d Dictionary with new parameter values
-             * @param cm ConnectorModel is passed along to validate new delay values
-             */
-            void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm );
-
-            //! Allows efficient initialization on contstruction
-            void  set_alpha( nest::double_t alpha_ )
-            {
-                alpha = alpha_;
-            }
+    /*
+    *  Modulation law of D2R synapses in the model by Mannella et al. 2016.
+    *  
+    *  weight = initial_weight/(1 + alpha*modulation)
+    *
+    *  assert( (1 + alpha*modulation)>1 )
+    */
+    template < typename valueT = nest::double_t >
+    class D2DivModulation : public AlphaModulation< valueT >
+    {
+        public:
 
-            virtual nest::double_t compute_modulation(nest::double_t modulation)
+            nest::double_t compute_modulation( nest::double_t modulation ) const
             {
-                return 1.0 - alpha*modulation;
+                return 1.0/(1.0 + this->alpha*modulation);
             }
     };
 
-
+    /*
+    *  The class D1Connection implements a dopaminergic synapse in which   
+    *  the information from the volume transmitter modulates the amplitude of the weight as
+    *  in D1R synapses in the model by Humphries et al. 2006 (http://dx.doi.org/10.1523/JNEUROSCI.3486-06.2006).
+    *  
+    *  weight = initial_weight*(1 + alpha*modulation)
+    *
+    *  Parameters:
+    *      initial_weight =>  the baseline value which has to be multiplied times the *modulation* 
+    *      alpha => amplitude of the modulated increment
+    */
     template < typename targetidentifierT >
-        void D2Connection< targetidentifierT >::get_status( DictionaryDatum& d ) const
-        {
-            ConnectionBase::get_status( d );
-            def< nest::double_t >( d, "alpha", alpha );
-            def< nest::long_t >( d, nest::names::size_of, sizeof( *this ) );
-        }
+        using D1Connection = ModulatoryConnection< targetidentifierT, D1Modulation<> >;
 
+    /*
+    *  The class D2Connection implements a dopaminergic synapse in which   
+    *  the information from the volume transmitter modulates the amplitude of the weight as
+    *  in D2R synapses in the model by Humphries et al. 2006 (http://dx.doi.org/10.1523/JNEUROSCI.3486-06.2006).
+    *  
+    *  weight = initial_weight*(1 - alpha*modulation)
+    *
+    *  Parameters:
+    *      initial_weight =>  the baseline value which has to be multiplied times the *modulation* 
+    *      alpha => amplitude of the modulated decrease
+    */
     template < typename targetidentifierT >
-        void D2Connection< targetidentifierT >::set_status( const DictionaryDatum& d,
-                nest::ConnectorModel& cm )
-        {
-            ConnectionBase::set_status( d, cm );
-            updateValue< nest::double_t >( d, "alpha", alpha );
-        }
-
+        using D2Connection = ModulatoryConnection< targetidentifierT, D2Modulation<> >;
 
     /*
     *  The class D2DivConnection implements a dopaminergic synapse in which   
@@ -202,69 +175,19 @@ namespace mynest
     *      alpha => amplitude of the modulated decrease
     */
     template < typename targetidentifierT >
-        class D2DivConnection : public ModulatoryConnection< targetidentifierT >
-    {
-        private:
-            
-            nest::double_t alpha;
-
-        public:
-            
-                //! Shortcut for base class
-            typedef ModulatoryConnection< targetidentifierT > ConnectionBase;
-
-
-            D2DivConnection() 
-                : ConnectionBase(), alpha(1.0)
-            {
-            }
-
-            // The following methods contain mostly fixed code to forward the corresponding
-            // tasks to corresponding methods in the base class and the w_ data member holding
-            // the weight.
-
-            //! Store connection status information in dictionary
-            void get_status( DictionaryDatum& d ) const;
-
-            /**
-             * Set connection status.
-             *
-             * @param d Dictionary with new parameter values
-             * @param cm ConnectorModel is passed along to validate new delay values
-             */
-            void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm );
-
-            //! Allows efficient initialization on contstruction
-            void  set_alpha( nest::double_t alpha_ )
-            {
-                alpha = alpha_;
-            }
-
-            virtual nest::double_t compute_modulation(nest::double_t modulation)
-            {
-                return 1.0/(1.0 + alpha*modulation);
-            }
-    };
-
+        using D2DivConnection = ModulatoryConnection< targetidentifierT, D2DivModulation<> >;
 
+    /*
+    *  Compact variants of the dopaminergic synapses, see ModulatoryHPCConnection.
+    */
     template < typename targetidentifierT >
-        void D2DivConnection< targetidentifierT >::get_status( DictionaryDatum& d ) const
-        {
-            ConnectionBase::get_status( d );
-            def< nest::double_t >( d, "alpha", alpha );
-            def< nest::long_t >( d, nest::names::size_of, sizeof( *this ) );
-        }
+        using D1HPCConnection = ModulatoryConnection< targetidentifierT, D1Modulation< float >, int >;
 
     template < typename targetidentifierT >
-        void D2DivConnection< targetidentifierT >::set_status( const DictionaryDatum& d,
-                nest::ConnectorModel& cm )
-        {
-            ConnectionBase::set_status( d, cm );
-            updateValue< nest::double_t >( d, "alpha", alpha );
-        }
-
-
+        using D2HPCConnection = ModulatoryConnection< targetidentifierT, D2Modulation< float >, int >;
 
+    template < typename targetidentifierT >
+        using D2DivHPCConnection = ModulatoryConnection< targetidentifierT, D2DivModulation< float >, int >;
 
 } // namespace nest
 
@@ -0,0 +1,89 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+#include "network.h"
+#include "dictdatum.h"
+#include "connector_model.h"
+#include "common_synapse_properties.h"
+#include "field_modulatory_connection.h"
+#include "nestmodule.h"
+
+namespace mynest
+{
+    //
+    // Implementation of class FieldModulatoryCommonProperties.
+    //
+
+    FieldModulatoryCommonProperties::FieldModulatoryCommonProperties()
+        : nest::CommonSynapseProperties(),
+        field_( 0 ),
+        max_concentration_(1.0),
+        inv_max_concentration_(1.0)
+    {
+    }
+
+    void FieldModulatoryCommonProperties::get_status( DictionaryDatum& d ) const
+    {
+        nest::CommonSynapseProperties::get_status( d );
+        def< nest::long_t >( d, "field", get_vt_gid() );
+        def< nest::double_t >( d, "max_concentration", max_concentration_ );
+    }
+
+    void FieldModulatoryCommonProperties::set_status( const DictionaryDatum& d, 
+            nest::ConnectorModel& cm )
+    {
+        nest::CommonSynapseProperties::set_status( d, cm );
+
+        nest::double_t max_concentration = max_concentration_;
+        if ( updateValue< nest::double_t >( d, "max_concentration", max_concentration ) )
+        {
+            if ( max_concentration <= 0 )
+                throw nest::BadProperty( "max_concentration must be positive." );
+            max_concentration_ = max_concentration;
+            inv_max_concentration_ = 1.0/max_concentration;
+        }
+
+        nest::long_t field_gid;
+        if ( updateValue< nest::long_t >( d, "field", field_gid ) )
+        {
+            field_ = dynamic_cast< modulation_field* >( 
+                    nest::NestModule::get_network().get_node( field_gid ) );
+
+            if ( field_ == 0 )
+                throw nest::BadProperty( "field must be a modulation_field." );
+        }
+    }
+
+    nest::Node* FieldModulatoryCommonProperties::get_node()
+    {
+        if ( field_ == 0 )
+            throw nest::BadProperty( "No modulation_field has "
+                    "been assigned to the synapse." );
+        else
+            return field_;
+    }
+
+} // of namespace nest
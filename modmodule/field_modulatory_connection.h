@@ -0,0 +1,254 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+/*
+ *  The class FieldModulatoryConnection implements modulatory synapses bound to
+ *  a modulation_field instead of a volume transmitter. Each synapse stores the 
+ *  index of the cell of the field it lies in and, when the field triggers it,
+ *  its weight becomes the baseline times the modulation law of the 
+ *  concentration of that cell, normalised by max_concentration.
+ *
+ *  Parameters (common to all synapses):
+ *      field => gid of the modulation_field
+ *      max_concentration => concentration giving a modulation of 1
+ *
+ *  Parameters (of each synapse):
+ *      weight_baseline =>  the baseline value which has to be multiplied times the *modulation* 
+ *      cell => index of the cell of the field, x + nx*(y + ny*z)
+ *      alpha => amplitude of the modulation (d1, d2 and d2_div laws only)
+ */
+
+#ifndef FIELD_MODULATORY_CONNECTION
+#define FIELD_MODULATORY_CONNECTION
+
+#include "connection.h"
+#include "modulatory_connection.h"
+#include "da_connection.h"
+#include "modulation_field.h"
+#include <cstdint>
+#include <vector>
+
+namespace mynest
+{
+
+    /**
+     * Class containing the common properties of the synapses bound to a modulation_field.
+     */
+    class FieldModulatoryCommonProperties : public nest::CommonSynapseProperties
+    {
+        public:
+
+            FieldModulatoryCommonProperties();
+
+            void get_status( DictionaryDatum& d ) const;
+
+            void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm );
+
+            nest::Node* get_node();
+
+            //! Compared by the connectors with the gid of the triggering node 
+            nest::long_t get_vt_gid() const
+            {
+                if ( field_ != 0 )
+                    return field_->get_gid();
+                else
+                    return -1;
+            }
+
+            //! Normalised modulation of the given cell
+            nest::double_t get_modulation( size_t cell ) const
+            {
+                return field_->get_concentration( cell )*inv_max_concentration_;
+            }
+
+            modulation_field* field_;
+            nest::double_t max_concentration_;
+            nest::double_t inv_max_concentration_; //!< 1/max_concentration
+    };
+
+    /**
+     * Field modulatory connection
+     * The local concentration of a modulator changes the 
+     * strength of the weights 
+     *
+     * @tparam modulationT policy giving the modulation law, see IdentityModulation 
+     */
+    template < typename targetidentifierT, typename modulationT = IdentityModulation<> >
+        class FieldModulatoryConnection : public nest::Connection< targetidentifierT >, 
+                                          public modulationT
+    {
+        public:
+            //! Type used to store weights
+            typedef typename modulationT::value_type value_type;
+
+            //! Type to use for representing common synapse properties
+            typedef FieldModulatoryCommonProperties CommonPropertiesType;
+
+            //! Shortcut for base class
+            typedef nest::Connection< targetidentifierT > ConnectionBase;
+
+        private:
+            value_type weight_baseline; //!< Initial synaptic weight
+            value_type weight_; //!< Synaptic weight
+            std::uint32_t cell_; //!< cell of the field
+
+        public:
+
+            /**
+             * Default Constructor.
+             * Sets default values for all parameters. Needed by GenericConnectorModel.
+             */
+            FieldModulatoryConnection() 
+                : ConnectionBase()
+                  ,weight_baseline(1.0)
+                  ,weight_(1.0)
+                  ,cell_(0)
+            {
+            }
+
+            /**
+             * Helper class defining which types of events can be transmitted.
+             * See ModulatoryConnection::ConnTestDummyNode.
+             */
+            class ConnTestDummyNode 
+                : public nest::ConnTestDummyNodeBase 
+            {
+                public:
+                    using nest::ConnTestDummyNodeBase::handles_test_event;
+                    nest::port handles_test_event( nest::SpikeEvent&, nest::rport )
+                    {
+                        return nest::invalid_port_;
+                    }
+            };
+
+            /**
+             * Check that requested connection can be created.
+             * See ModulatoryConnection::check_connection().
+             */
+            void check_connection( nest::Node& s,
+                    nest::Node& t,
+                    nest::rport receptor_type,
+                    nest::double_t,
+                    const CommonPropertiesType& )
+            {
+                ConnTestDummyNode dummy_target;
+                ConnectionBase::check_connection_( dummy_target, s, t, receptor_type );
+            }
+
+            /**
+             * Send an event to the receiver of this connection.
+             * @param e The event to send
+             * @param t Thread
+             * @param t_lastspike Point in time of last spike sent.
+             * @param cp Common properties to all synapses.
+             */
+            void send( nest::Event& e,
+                    nest::thread t,
+                    nest::double_t,
+                    const CommonPropertiesType& )
+            {
+                e.set_weight( weight_ );
+                e.set_delay( ConnectionBase::get_delay_steps() );
+                e.set_receiver( *ConnectionBase::get_target( t ) );
+                e.set_rport( ConnectionBase::get_rport() );
+                e(); // this sends the event
+            }
+
+            /**
+             * triggers an update of a synaptic weight from the concentration 
+             * of its cell
+             * @param t Thread
+             * @param modulatory_spikes spikes released by the field, not used
+             * @param t_trig update triggering time 
+             * @param cp Common properties to all synapses.
+             */
+            void trigger_update_weight( nest::thread,
+                    const std::vector< nest::spikecounter >&,
+                    nest::double_t,
+                    const CommonPropertiesType& cp )
+            {
+                weight_ = weight_baseline*modulationT::compute_modulation( cp.get_modulation( cell_ ) );
+            }
+
+            //! Store connection status information in dictionary
+            void get_status( DictionaryDatum& d ) const
+            {
+                ConnectionBase::get_status( d );
+                def< nest::double_t >( d, nest::names::weight, weight_ );
+                def< nest::double_t >( d, "weight_baseline", weight_baseline );
+                def< nest::long_t >( d, "cell", cell_ );
+                modulationT::get_status( d );
+                def< nest::long_t >( d, nest::names::size_of, sizeof( *this ) );
+            }
+
+            /**
+             * Set connection status.
+             *
+             * @param d Dictionary with new parameter values
+             * @param cm ConnectorModel is passed along to validate new delay values
+             */
+            void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm )
+            {
+                ConnectionBase::set_status( d, cm );
+                updateValue< nest::double_t >( d, nest::names::weight, weight_ );
+                updateValue< nest::double_t >( d, "weight_baseline", weight_baseline );
+
+                nest::long_t cell;
+                if ( updateValue< nest::long_t >( d, "cell", cell ) )
+                {
+                    const CommonPropertiesType& cp = 
+                        static_cast< const CommonPropertiesType& >( cm.get_common_properties() );
+                    if ( cell < 0 or ( cp.field_ != 0 and static_cast< size_t >( cell ) >= cp.field_->size() ) )
+                        throw nest::BadProperty( "cell must be a cell of the modulation_field." );
+                    cell_ = cell;
+                }
+
+                modulationT::set_status( d );
+            }
+
+            //! Allows efficient initialization on contstruction
+            void  set_weight( nest::double_t w )
+            {
+                weight_ = w;
+            }
+    };
+
+    /*
+    *  Laws of the modulatory, d1, d2 and d2_div synapses applied to the 
+    *  local concentration of a modulation_field
+    */
+    template < typename targetidentifierT >
+        using FieldD1Connection = FieldModulatoryConnection< targetidentifierT, D1Modulation<> >;
+    
+    template < typename targetidentifierT >
+        using FieldD2Connection = FieldModulatoryConnection< targetidentifierT, D2Modulation<> >;
+    
+    template < typename targetidentifierT >
+        using FieldD2DivConnection = FieldModulatoryConnection< targetidentifierT, D2DivModulation<> >;
+
+} // namespace nest
+
+#endif // FIELD_MODULATORY_CONNECTION
@@ -38,6 +38,9 @@
 #include "booldatum.h"
 #include "integerdatum.h"
 #include "tokenarray.h"
+#include "arraydatum.h"
+#include "doublevectordatum.h"
+#include "stringdatum.h"
 #include "exceptions.h"
 #include "sliexceptions.h"
 #include "nestmodule.h"
@@ -48,6 +51,18 @@
 #include "modmodule.h"
 #include "modulatory_connection.h"
 #include "da_connection.h"
+#include "modulatory_connection_hom.h"
+#include "multi_modulatory_connection.h"
+#include "modulatory_stdp_connection.h"
+#include "field_modulatory_connection.h"
+#include "modulation_field.h"
+#include "modulatory_checkpoint.h"
+#include "modulation_recorder.h"
+#include "modulation_replay.h"
+#include "modulation_rate.h"
+#include "modulation_reducer.h"
+#include "modulatory_parameters.h"
+#include "modulatory_footprint.h"
 
 // -- Interface to dynamic module loader ---------------------------------------
 
@@ -93,6 +108,108 @@ mynest::ModModule::commandstring( void ) const
 }
 
 
+//-------------------------------------------------------------------------------------
+
+/*
+ * Write the modulatory synapses to a binary file.
+ *
+ * SLI signature: (filename) SaveModulatorySynapses -> n_synapses
+ */
+void
+mynest::ModModule::SaveModulatorySynapses_sFunction::execute( SLIInterpreter* i ) const
+{
+  i->assert_stack_load( 1 );
+
+  const std::string filename = getValue< std::string >( i->OStack.pick( 0 ) );
+  const nest::long_t n = save_modulatory_synapses( filename );
+
+  i->OStack.pop();
+  i->OStack.push( n );
+  i->EStack.pop();
+}
+
+/*
+ * Recreate the modulatory synapses from a binary file.
+ *
+ * SLI signature: (filename) LoadModulatorySynapses -> n_synapses
+ */
+void
+mynest::ModModule::LoadModulatorySynapses_sFunction::execute( SLIInterpreter* i ) const
+{
+  i->assert_stack_load( 1 );
+
+  const std::string filename = getValue< std::string >( i->OStack.pick( 0 ) );
+  const nest::long_t n = load_modulatory_synapses( filename );
+
+  i->OStack.pop();
+  i->OStack.push( n );
+  i->EStack.pop();
+}
+
+/*
+ * Read one parameter of a set of connections.
+ *
+ * SLI signature: connections (name) GetModulatoryParameters -> values
+ */
+void
+mynest::ModModule::GetModulatoryParameters_a_sFunction::execute( SLIInterpreter* i ) const
+{
+  i->assert_stack_load( 2 );
+
+  // the connections are used in place, not copied
+  const ArrayDatum* connections = dynamic_cast< ArrayDatum* >( i->OStack.pick( 1 ).datum() );
+  if ( connections == 0 )
+    throw nest::BadProperty( "Connections must be given as returned by GetConnections." );
+  const std::string name = getValue< std::string >( i->OStack.pick( 0 ) );
+
+  std::vector< double >* values = new std::vector< double >();
+  DoubleVectorDatum result( values );
+  get_modulatory_parameters( *connections, name, *values );
+
+  i->OStack.pop( 2 );
+  i->OStack.push( result );
+  i->EStack.pop();
+}
+
+/*
+ * Set one parameter of a set of connections.
+ *
+ * SLI signature: connections (name) values SetModulatoryParameters -> -
+ */
+void
+mynest::ModModule::SetModulatoryParameters_a_s_vFunction::execute( SLIInterpreter* i ) const
+{
+  i->assert_stack_load( 3 );
+
+  const ArrayDatum* connections = dynamic_cast< ArrayDatum* >( i->OStack.pick( 2 ).datum() );
+  if ( connections == 0 )
+    throw nest::BadProperty( "Connections must be given as returned by GetConnections." );
+  const std::string name = getValue< std::string >( i->OStack.pick( 1 ) );
+
+  // numpy arrays arrive as double vectors and are used in place
+  DoubleVectorDatum* values = dynamic_cast< DoubleVectorDatum* >( i->OStack.pick( 0 ).datum() );
+  if ( values != 0 )
+    set_modulatory_parameters( *connections, name, **values );
+  else
+    set_modulatory_parameters( *connections, name, 
+      getValue< std::vector< double > >( i->OStack.pick( 0 ) ) );
+
+  i->OStack.pop( 3 );
+  i->EStack.pop();
+}
+
+/*
+ * Report the memory footprint and the trigger load of the modulatory models.
+ *
+ * SLI signature: GetModulatoryFootprint -> dict
+ */
+void
+mynest::ModModule::GetModulatoryFootprintFunction::execute( SLIInterpreter* i ) const
+{
+  i->OStack.push( get_modulatory_footprint() );
+  i->EStack.pop();
+}
+
 //-------------------------------------------------------------------------------------
 
 void
@@ -118,4 +235,101 @@ mynest::ModModule::init( SLIInterpreter* i )
     nest::NestModule::get_network(), "d2_synapse" );
   nest::register_connection_model< D2DivConnection< nest::TargetIdentifierPtrRport > >(
     nest::NestModule::get_network(), "d2_div_synapse" );
+
+  /* Homogeneous variants: all the synapses of a model share baseline weight, 
+     modulation parameters and deliver interval, which are set with SetDefaults
+     or CopyModel.
+  */
+  nest::register_connection_model< ModulatoryHomConnection< nest::TargetIdentifierPtrRport > >(
+    nest::NestModule::get_network(), "modulatory_synapse_hom" );
+  nest::register_connection_model< D1HomConnection< nest::TargetIdentifierPtrRport > >(
+    nest::NestModule::get_network(), "d1_synapse_hom" );
+  nest::register_connection_model< D2HomConnection< nest::TargetIdentifierPtrRport > >(
+    nest::NestModule::get_network(), "d2_synapse_hom" );
+  nest::register_connection_model< D2DivHomConnection< nest::TargetIdentifierPtrRport > >(
+    nest::NestModule::get_network(), "d2_div_synapse_hom" );
+
+  /* Compact variants for very large networks: index targets (rport 0 only),
+     single precision weights and alpha, 32-bit deliver interval.
+  */
+  nest::register_connection_model< ModulatoryHPCConnection< nest::TargetIdentifierIndex > >(
+    nest::NestModule::get_network(), "modulatory_synapse_hpc" );
+  nest::register_connection_model< D1HPCConnection< nest::TargetIdentifierIndex > >(
+    nest::NestModule::get_network(), "d1_synapse_hpc" );
+  nest::register_connection_model< D2HPCConnection< nest::TargetIdentifierIndex > >(
+    nest::NestModule::get_network(), "d2_synapse_hpc" );
+  nest::register_connection_model< D2DivHPCConnection< nest::TargetIdentifierIndex > >(
+    nest::NestModule::get_network(), "d2_div_synapse_hpc" );
+
+  /* Synapses driven by two volume transmitters (vts), whose modulations
+     are combined by product or sum.
+  */
+  nest::register_connection_model< MultiModulatoryConnection2< nest::TargetIdentifierPtrRport > >(
+    nest::NestModule::get_network(), "multi_modulatory_synapse" );
+  nest::register_connection_model< MultiD1Connection< nest::TargetIdentifierPtrRport > >(
+    nest::NestModule::get_network(), "multi_d1_synapse" );
+  nest::register_connection_model< MultiD2Connection< nest::TargetIdentifierPtrRport > >(
+    nest::NestModule::get_network(), "multi_d2_synapse" );
+  nest::register_connection_model< MultiD2DivConnection< nest::TargetIdentifierPtrRport > >(
+    nest::NestModule::get_network(), "multi_d2_div_synapse" );
+
+  /* Dopamine gated STDP of the learned weight fused with the modulation 
+     laws, in a single synapse per pair of neurons.
+  */
+  nest::register_connection_model< StdpModulatoryConnection< nest::TargetIdentifierPtrRport > >(
+    nest::NestModule::get_network(), "stdp_modulatory_synapse" );
+  nest::register_connection_model< StdpD1Connection< nest::TargetIdentifierPtrRport > >(
+    nest::NestModule::get_network(), "stdp_d1_synapse" );
+  nest::register_connection_model< StdpD2Connection< nest::TargetIdentifierPtrRport > >(
+    nest::NestModule::get_network(), "stdp_d2_synapse" );
+  nest::register_connection_model< StdpD2DivConnection< nest::TargetIdentifierPtrRport > >(
+    nest::NestModule::get_network(), "stdp_d2_div_synapse" );
+
+  /* Spatial modulation: the modulation_field node diffuses the spikes of 
+     the modulatory neurons on a grid and the field_ synapses read the 
+     concentration of their own cell.
+  */
+  nest::register_model< modulation_field >(
+    nest::NestModule::get_network(), "modulation_field" );
+  nest::register_connection_model< FieldModulatoryConnection< nest::TargetIdentifierPtrRport > >(
+    nest::NestModule::get_network(), "field_modulatory_synapse" );
+  nest::register_connection_model< FieldD1Connection< nest::TargetIdentifierPtrRport > >(
+    nest::NestModule::get_network(), "field_d1_synapse" );
+  nest::register_connection_model< FieldD2Connection< nest::TargetIdentifierPtrRport > >(
+    nest::NestModule::get_network(), "field_d2_synapse" );
+  nest::register_connection_model< FieldD2DivConnection< nest::TargetIdentifierPtrRport > >(
+    nest::NestModule::get_network(), "field_d2_div_synapse" );
+
+  /* Register the device recording the modulation of a volume transmitter.
+  */
+  nest::register_model< modulation_recorder >(
+    nest::NestModule::get_network(), "modulation_recorder" );
+
+  /* Register the node replaying a recorded modulation in place of a 
+     volume transmitter.
+  */
+  nest::register_model< modulation_replay >(
+    nest::NestModule::get_network(), "modulation_replay" );
+
+  /* Register the node passing a continuous modulation, settable or driven
+     by currents, in place of a volume transmitter.
+  */
+  nest::register_model< modulation_rate >(
+    nest::NestModule::get_network(), "modulation_rate" );
+
+  /* Register the node summing the modulatory spikes of all MPI processes
+     once per interval in place of a volume transmitter.
+  */
+  nest::register_model< modulation_reducer >(
+    nest::NestModule::get_network(), "modulation_reducer" );
+
+  /* Register the SLI functions. The tries mapping the user-level names to
+     them are defined in sli/modmodule-init.sli, GetModulatoryFootprint 
+     takes no argument and is registered under its own name.
+  */
+  i->createcommand( "SaveModulatorySynapses_s", &saveModulatorySynapses_sFunction );
+  i->createcommand( "LoadModulatorySynapses_s", &loadModulatorySynapses_sFunction );
+  i->createcommand( "GetModulatoryParameters_a_s", &getModulatoryParameters_a_sFunction );
+  i->createcommand( "SetModulatoryParameters_a_s_v", &setModulatoryParameters_a_s_vFunction );
+  i->createcommand( "GetModulatoryFootprint", &getModulatoryFootprintFunction );
 } // ModModule::init()
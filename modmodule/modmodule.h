@@ -77,6 +77,66 @@ public:
    */
   const std::string commandstring( void ) const;
 
+public:
+  // Classes implementing your functions -----------------------------
+
+  /**
+   * Write all the local modulatory synapses to a binary checkpoint file.
+   * @see save_modulatory_synapses()
+   */
+  class SaveModulatorySynapses_sFunction : public SLIFunction
+  {
+  public:
+    void execute( SLIInterpreter* ) const;
+  };
+
+  /**
+   * Recreate the modulatory synapses stored in a binary checkpoint file.
+   * @see load_modulatory_synapses()
+   */
+  class LoadModulatorySynapses_sFunction : public SLIFunction
+  {
+  public:
+    void execute( SLIInterpreter* ) const;
+  };
+
+  /**
+   * Read one parameter of a set of connections into a vector of doubles.
+   * @see get_modulatory_parameters()
+   */
+  class GetModulatoryParameters_a_sFunction : public SLIFunction
+  {
+  public:
+    void execute( SLIInterpreter* ) const;
+  };
+
+  /**
+   * Set one parameter of a set of connections from a vector of doubles.
+   * @see set_modulatory_parameters()
+   */
+  class SetModulatoryParameters_a_s_vFunction : public SLIFunction
+  {
+  public:
+    void execute( SLIInterpreter* ) const;
+  };
+
+  /**
+   * Report the memory footprint and the trigger load of the modulatory models.
+   * @see get_modulatory_footprint()
+   */
+  class GetModulatoryFootprintFunction : public SLIFunction
+  {
+  public:
+    void execute( SLIInterpreter* ) const;
+  };
+
+private:
+  /** Instances of the function classes */
+  SaveModulatorySynapses_sFunction saveModulatorySynapses_sFunction;
+  LoadModulatorySynapses_sFunction loadModulatorySynapses_sFunction;
+  GetModulatoryParameters_a_sFunction getModulatoryParameters_a_sFunction;
+  SetModulatoryParameters_a_s_vFunction setModulatoryParameters_a_s_vFunction;
+  GetModulatoryFootprintFunction getModulatoryFootprintFunction;
 };
 } // namespace mynest
 
@@ -0,0 +1,308 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+#include "network.h"
+#include "dictdatum.h"
+#include "dictutils.h"
+#include "exceptions.h"
+#include "modulation_field.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mynest
+{
+    //
+    // Implementation of class modulation_field::Parameters_.
+    //
+
+    modulation_field::Parameters_::Parameters_()
+        : nx_( 1 ),
+        ny_( 1 ),
+        nz_( 1 ),
+        dims_( 2 ),
+        cell_size_( 1.0 ),
+        diffusion_( 0.0 ),
+        tau_decay_( 100.0 ),
+        deliver_interval_( 1 )
+    {
+    }
+
+    void modulation_field::Parameters_::get( DictionaryDatum& d ) const
+    {
+        std::vector< nest::long_t > shape;
+        shape.push_back( nx_ );
+        shape.push_back( ny_ );
+        if ( dims_ == 3 )
+            shape.push_back( nz_ );
+
+        def< std::vector< nest::long_t > >( d, "shape", shape );
+        def< nest::double_t >( d, "cell_size", cell_size_ );
+        def< nest::double_t >( d, "diffusion", diffusion_ );
+        def< nest::double_t >( d, "tau_decay", tau_decay_ );
+        def< nest::long_t >( d, "deliver_interval", deliver_interval_ );
+        def< std::vector< nest::long_t > >( d, "sources", sources_ );
+        def< std::vector< nest::double_t > >( d, "positions", positions_ );
+    }
+
+    void modulation_field::Parameters_::set( const DictionaryDatum& d )
+    {
+        std::vector< nest::long_t > shape;
+        if ( updateValue< std::vector< nest::long_t > >( d, "shape", shape ) )
+        {
+            if ( shape.size() != 2 and shape.size() != 3 )
+                throw nest::BadProperty( "shape must have 2 or 3 values." );
+            for ( size_t i = 0; i < shape.size(); ++i )
+                if ( shape[ i ] < 1 )
+                    throw nest::BadProperty( "shape must be positive." );
+            dims_ = shape.size();
+            nx_ = shape[ 0 ];
+            ny_ = shape[ 1 ];
+            nz_ = ( dims_ == 3 ) ? shape[ 2 ] : 1;
+        }
+
+        updateValue< nest::double_t >( d, "cell_size", cell_size_ );
+        updateValue< nest::double_t >( d, "diffusion", diffusion_ );
+        updateValue< nest::double_t >( d, "tau_decay", tau_decay_ );
+        updateValue< nest::long_t >( d, "deliver_interval", deliver_interval_ );
+        updateValue< std::vector< nest::long_t > >( d, "sources", sources_ );
+        updateValue< std::vector< nest::double_t > >( d, "positions", positions_ );
+
+        if ( cell_size_ <= 0 )
+            throw nest::BadProperty( "cell_size must be positive." );
+        if ( diffusion_ < 0 )
+            throw nest::BadProperty( "diffusion must be non-negative." );
+        if ( tau_decay_ <= 0 )
+            throw nest::BadProperty( "tau_decay must be positive." );
+        if ( deliver_interval_ < 1 )
+            throw nest::BadProperty( "deliver_interval must be positive." );
+        if ( positions_.size() != dims_*sources_.size() )
+            throw nest::BadProperty( "positions needs one value per axis for each source." );
+    }
+
+    //
+    // Implementation of class modulation_field.
+    //
+
+    modulation_field::modulation_field()
+        : nest::Node(),
+        P_(),
+        S_(),
+        B_()
+    {
+    }
+
+    modulation_field::modulation_field( const modulation_field& n )
+        : nest::Node( n ),
+        P_( n.P_ ),
+        S_(),
+        B_()
+    {
+    }
+
+    void modulation_field::init_state_( const nest::Node& )
+    {
+        const size_t padded_size = ( P_.nx_ + 2 )*( P_.ny_ + 2 )*( P_.nz_ + 2 );
+        S_.c_.assign( padded_size, 0.0 );
+        S_.next_.assign( padded_size, 0.0 );
+    }
+
+    void modulation_field::init_buffers_()
+    {
+        for ( size_t k = 0; k < B_.arrivals_.size(); ++k )
+            B_.arrivals_[ k ].clear();
+        B_.release_.assign( B_.cells_.size(), 0.0 );
+        B_.spikes_.clear();
+    }
+
+    void modulation_field::calibrate()
+    {
+        if ( S_.c_.size() != ( P_.nx_ + 2 )*( P_.ny_ + 2 )*( P_.nz_ + 2 ) )
+        {
+            init_state_( *this );
+            init_buffers_();
+        }
+
+        // sources outside of the grid release in the nearest border cell
+        std::vector< size_t > cells;
+        B_.source_cell_.clear();
+        const size_t n[ 3 ] = { P_.nx_, P_.ny_, P_.nz_ };
+        for ( size_t s = 0; s < P_.sources_.size(); ++s )
+        {
+            size_t cell = 0;
+            size_t stride = 1;
+            for ( size_t a = 0; a < P_.dims_; ++a )
+            {
+                const nest::double_t x = std::floor( P_.positions_[ s*P_.dims_ + a ]/P_.cell_size_ );
+                const size_t i = static_cast< size_t >( 
+                        std::min( std::max( x, 0.0 ), static_cast< nest::double_t >( n[ a ] - 1 ) ) );
+                cell += i*stride;
+                stride *= n[ a ];
+            }
+            
+            const size_t k = std::find( cells.begin(), cells.end(), padded( cell ) ) - cells.begin();
+            if ( k == cells.size() )
+                cells.push_back( padded( cell ) );
+            B_.source_cell_[ P_.sources_[ s ] ] = k;
+        }
+
+        // spikes still to be delivered are kept unless the cells changed
+        if ( cells != B_.cells_ )
+        {
+            B_.cells_ = cells;
+            B_.arrivals_.assign( cells.size(), nest::RingBuffer() );
+            B_.release_.assign( cells.size(), 0.0 );
+        }
+        for ( size_t k = 0; k < B_.arrivals_.size(); ++k )
+            B_.arrivals_[ k ].resize();
+    }
+
+    nest::port modulation_field::handles_test_event( nest::SpikeEvent& e, nest::rport receptor_type )
+    {
+        if ( receptor_type != 0 )
+            throw nest::UnknownReceptorType( receptor_type, get_name() );
+
+        // the position of the sender must be known to release its spikes
+        const nest::long_t sender = e.get_sender().get_gid();
+        if ( std::find( P_.sources_.begin(), P_.sources_.end(), sender ) == P_.sources_.end() )
+            throw nest::IllegalConnection( "The modulation_field can only be connected to "
+                    "the neurons listed in its sources." );
+        return 0;
+    }
+
+    void modulation_field::handle( nest::SpikeEvent& e )
+    {
+        // a neuron removed from the sources after it was connected has no cell
+        std::map< nest::long_t, size_t >::const_iterator cell = 
+            B_.source_cell_.find( e.get_sender_gid() );
+        if ( cell == B_.source_cell_.end() )
+            return;
+
+        B_.arrivals_[ cell->second ].add_value( 
+                e.get_rel_delivery_steps( network()->get_slice_origin() ), e.get_multiplicity() );
+    }
+
+    void modulation_field::step( nest::double_t dt )
+    {
+        const size_t nx = P_.nx_ + 2;
+        const size_t ny = P_.ny_ + 2;
+        const size_t nz = P_.nz_ + 2;
+        const size_t sy = nx;
+        const size_t sz = nx*ny;
+        std::vector< nest::double_t >& c = S_.c_;
+
+        // no flux through the border: ghost cells copy their neighbour
+        for ( size_t z = 1; z < nz - 1; ++z )
+            for ( size_t y = 1; y < ny - 1; ++y )
+            {
+                c[ z*sz + y*sy ] = c[ z*sz + y*sy + 1 ];
+                c[ z*sz + y*sy + nx - 1 ] = c[ z*sz + y*sy + nx - 2 ];
+            }
+        for ( size_t z = 1; z < nz - 1; ++z )
+            for ( size_t x = 0; x < nx; ++x )
+            {
+                c[ z*sz + x ] = c[ z*sz + sy + x ];
+                c[ z*sz + ( ny - 1 )*sy + x ] = c[ z*sz + ( ny - 2 )*sy + x ];
+            }
+        for ( size_t i = 0; i < sz; ++i )
+        {
+            c[ i ] = c[ sz + i ];
+            c[ ( nz - 1 )*sz + i ] = c[ ( nz - 2 )*sz + i ];
+        }
+
+        // in 2D the z neighbours are the cell itself and do not contribute
+        const nest::double_t k = dt*P_.diffusion_/( P_.cell_size_*P_.cell_size_ );
+        const nest::double_t decay = std::exp( -dt/P_.tau_decay_ );
+        std::vector< nest::double_t >& next = S_.next_;
+        for ( size_t z = 1; z < nz - 1; ++z )
+            for ( size_t y = 1; y < ny - 1; ++y )
+            {
+                const size_t row = z*sz + y*sy;
+                for ( size_t i = row + 1; i < row + nx - 1; ++i )
+                    next[ i ] = decay*( c[ i ] + k*( c[ i - 1 ] + c[ i + 1 ] 
+                                + c[ i - sy ] + c[ i + sy ] 
+                                + c[ i - sz ] + c[ i + sz ] - 6*c[ i ] ) );
+            }
+
+        std::swap( S_.c_, S_.next_ );
+    }
+
+    void modulation_field::update( nest::Time const& origin, const nest::long_t from, const nest::long_t to )
+    {
+        // spikes are released in the interval of their delivery step
+        for ( nest::long_t lag = from; lag < to; ++lag )
+            for ( size_t k = 0; k < B_.arrivals_.size(); ++k )
+                B_.release_[ k ] += B_.arrivals_[ k ].get_value( lag );
+
+        const nest::long_t now = origin.get_steps() + to;
+        const nest::long_t interval = P_.deliver_interval_*network()->get_min_delay();
+        if ( now % interval != 0 )
+            return;
+
+        // release the spikes of the interval, then let them spread
+        nest::double_t released = 0.0;
+        for ( size_t k = 0; k < B_.cells_.size(); ++k )
+        {
+            S_.c_[ B_.cells_[ k ] ] += B_.release_[ k ];
+            released += B_.release_[ k ];
+            B_.release_[ k ] = 0.0;
+        }
+
+        // explicit steps are stable up to cell_size^2/(6*diffusion)
+        const nest::double_t t = nest::Time( nest::Time::step( interval ) ).get_ms();
+        size_t num_steps = 1;
+        if ( P_.diffusion_ > 0 )
+            num_steps = static_cast< size_t >( std::ceil( 
+                        t*6*P_.diffusion_/( P_.cell_size_*P_.cell_size_ ) ) );
+        num_steps = std::max< size_t >( num_steps, 1 );
+        for ( size_t s = 0; s < num_steps; ++s )
+            step( t/num_steps );
+
+        // the synapses read the field, the spikes only carry the time
+        const nest::double_t t_trig = nest::Time( nest::Time::step( now ) ).get_ms();
+        B_.spikes_.assign( 1, nest::spikecounter( t_trig, released ) );
+        network()->trigger_update_weight( get_gid(), B_.spikes_, t_trig );
+    }
+
+    void modulation_field::get_status( DictionaryDatum& d ) const
+    {
+        P_.get( d );
+
+        std::vector< nest::double_t > concentration( size() );
+        if ( not S_.c_.empty() )
+            for ( size_t i = 0; i < concentration.size(); ++i )
+                concentration[ i ] = S_.c_[ padded( i ) ];
+        def< std::vector< nest::double_t > >( d, "concentration", concentration );
+    }
+
+    void modulation_field::set_status( const DictionaryDatum& d )
+    {
+        Parameters_ ptmp = P_;
+        ptmp.set( d );
+        P_ = ptmp;
+    }
+
+} // namespace mynest
@@ -0,0 +1,184 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+/*
+ *  The modulation_field node replaces the volume transmitter when the 
+ *  concentration of the modulator has to vary in space.
+ *
+ *  The modulatory neurons are connected to the field, each at its own 
+ *  position. Once per deliver interval the field releases their spikes
+ *  in the cells of a coarse 2D or 3D grid, lets the concentration diffuse
+ *  and decay over the interval with an explicit 7-point stencil, and 
+ *  triggers the synapses bound to it (see field_modulatory_connection.h),
+ *  each of which reads the concentration of its own cell.
+ *
+ *  Only the neurons listed in sources can be connected to the field. Their
+ *  spikes are buffered at their delivery step, one ring buffer per cell 
+ *  holding sources, and released in the interval they are delivered in.
+ *
+ *  The grid is stored with a layer of ghost cells, copied from the border 
+ *  before each step (no flux through the border), so that the stencil runs
+ *  over contiguous rows without branches.
+ *
+ *  Parameters:
+ *      shape => number of cells along each axis, 2 or 3 values
+ *      cell_size => side of a cell, in the units of positions
+ *      diffusion => diffusion coefficient (units of positions^2/ms)
+ *      tau_decay => time constant of the decay of the concentration (ms)
+ *      deliver_interval => update and trigger period, in multiples of min_delay
+ *      sources => gids of the modulatory neurons
+ *      positions => position of each source, one value per axis, flattened
+ *      concentration => current concentration of each cell (read only)
+ */
+
+#ifndef MODULATION_FIELD_H
+#define MODULATION_FIELD_H
+
+#include "node.h"
+#include "event.h"
+#include "nest_time.h"
+#include "dictdatum.h"
+#include "spikecounter.h"
+#include "ring_buffer.h"
+#include <map>
+#include <vector>
+
+namespace mynest
+{
+
+    class modulation_field : public nest::Node
+    {
+        public:
+
+            modulation_field();
+            modulation_field( const modulation_field& );
+
+            //! Like the volume transmitter, the field exists once per process
+            bool has_proxies() const
+            {
+                return false;
+            }
+
+            bool local_receiver() const
+            {
+                return false;
+            }
+
+            bool one_node_per_process() const
+            {
+                return true;
+            }
+
+            using nest::Node::handle;
+            using nest::Node::handles_test_event;
+
+            void handle( nest::SpikeEvent& e );
+
+            nest::port handles_test_event( nest::SpikeEvent&, nest::rport receptor_type );
+
+            void get_status( DictionaryDatum& d ) const;
+            void set_status( const DictionaryDatum& d );
+
+            //! Number of cells of the grid
+            size_t size() const
+            {
+                return P_.nx_*P_.ny_*P_.nz_;
+            }
+
+            //! Concentration of the given cell, 0 outside of the grid 
+            nest::double_t get_concentration( size_t cell ) const
+            {
+                if ( cell >= size() )
+                    return 0.0;
+                return S_.c_[ padded( cell ) ];
+            }
+
+        private:
+
+            void init_state_( const nest::Node& proto );
+            void init_buffers_();
+            void calibrate();
+
+            void update( nest::Time const&, const nest::long_t, const nest::long_t );
+
+            //! Advance the concentration by dt ms with one stencil step 
+            void step( nest::double_t dt );
+
+            //! Index in the padded grid of a cell of the grid
+            size_t padded( size_t cell ) const
+            {
+                const size_t x = cell % P_.nx_;
+                const size_t y = ( cell/P_.nx_ ) % P_.ny_;
+                const size_t z = cell/( P_.nx_*P_.ny_ );
+                return ( ( z + 1 )*( P_.ny_ + 2 ) + y + 1 )*( P_.nx_ + 2 ) + x + 1;
+            }
+
+            // ------------------------------------------------------------
+
+            struct Parameters_
+            {
+                size_t nx_, ny_, nz_; //!< cells along each axis, nz_ is 1 in 2D
+                size_t dims_; //!< 2 or 3 
+                nest::double_t cell_size_;
+                nest::double_t diffusion_;
+                nest::double_t tau_decay_;
+                nest::long_t deliver_interval_;
+                std::vector< nest::long_t > sources_;
+                std::vector< nest::double_t > positions_;
+
+                Parameters_();
+
+                void get( DictionaryDatum& ) const;
+                void set( const DictionaryDatum& );
+            };
+
+            // ------------------------------------------------------------
+
+            struct State_
+            {
+                std::vector< nest::double_t > c_; //!< padded concentration grid
+                std::vector< nest::double_t > next_; //!< padded grid of the next step
+            };
+
+            // ------------------------------------------------------------
+
+            struct Buffers_
+            {
+                std::map< nest::long_t, size_t > source_cell_; //!< index in cells_ of each source gid
+                std::vector< size_t > cells_; //!< padded cells holding sources
+                std::vector< nest::RingBuffer > arrivals_; //!< spikes of each of cells_, by delivery step
+                std::vector< nest::double_t > release_; //!< spikes of the interval in each of cells_
+                std::vector< nest::spikecounter > spikes_; //!< passed to the triggered synapses
+            };
+
+            Parameters_ P_;
+            State_ S_;
+            Buffers_ B_;
+    };
+
+} // namespace mynest
+
+#endif // MODULATION_FIELD_H
@@ -0,0 +1,151 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+#include "network.h"
+#include "dictdatum.h"
+#include "dictutils.h"
+#include "exceptions.h"
+#include "modulation_rate.h"
+
+namespace mynest
+{
+    //
+    // Implementation of class modulation_rate::Parameters_ and State_.
+    //
+
+    modulation_rate::Parameters_::Parameters_()
+        : rate_( 0.0 ),
+        gain_( 1.0 ),
+        deliver_interval_( 1 )
+    {
+    }
+
+    void modulation_rate::Parameters_::get( DictionaryDatum& d ) const
+    {
+        def< nest::double_t >( d, "rate", rate_ );
+        def< nest::double_t >( d, "gain", gain_ );
+        def< nest::long_t >( d, "deliver_interval", deliver_interval_ );
+    }
+
+    void modulation_rate::Parameters_::set( const DictionaryDatum& d )
+    {
+        updateValue< nest::double_t >( d, "rate", rate_ );
+        updateValue< nest::double_t >( d, "gain", gain_ );
+        updateValue< nest::long_t >( d, "deliver_interval", deliver_interval_ );
+        if ( deliver_interval_ < 1 )
+            throw nest::BadProperty( "deliver_interval must be positive." );
+    }
+
+    modulation_rate::State_::State_()
+        : input_sum_( 0.0 ),
+        num_steps_( 0 ),
+        modulation_( 0.0 )
+    {
+    }
+
+    //
+    // Implementation of class modulation_rate.
+    //
+
+    modulation_rate::modulation_rate()
+        : ModulationSignal( true ),
+        P_(),
+        S_(),
+        B_()
+    {
+    }
+
+    modulation_rate::modulation_rate( const modulation_rate& n )
+        : ModulationSignal( n ),
+        P_( n.P_ ),
+        S_(),
+        B_()
+    {
+    }
+
+    void modulation_rate::init_state_( const nest::Node& )
+    {
+        S_ = State_();
+    }
+
+    void modulation_rate::init_buffers_()
+    {
+        B_.input_.clear();
+        spikes_.clear();
+    }
+
+    void modulation_rate::calibrate()
+    {
+    }
+
+    nest::port modulation_rate::handles_test_event( nest::CurrentEvent&, nest::rport receptor_type )
+    {
+        if ( receptor_type != 0 )
+            throw nest::UnknownReceptorType( receptor_type, get_name() );
+        return 0;
+    }
+
+    void modulation_rate::handle( nest::CurrentEvent& e )
+    {
+        B_.input_.add_value( e.get_rel_delivery_steps( network()->get_slice_origin() ),
+                e.get_weight()*e.get_current() );
+    }
+
+    void modulation_rate::update( nest::Time const& origin, const nest::long_t from, const nest::long_t to )
+    {
+        for ( nest::long_t lag = from; lag < to; ++lag )
+            S_.input_sum_ += B_.input_.get_value( lag );
+        S_.num_steps_ += to - from;
+
+        const nest::long_t now = origin.get_steps() + to;
+        const nest::long_t interval = P_.deliver_interval_*network()->get_min_delay();
+        if ( now % interval != 0 )
+            return;
+
+        S_.modulation_ = P_.rate_ + P_.gain_*S_.input_sum_/S_.num_steps_;
+        S_.input_sum_ = 0.0;
+        S_.num_steps_ = 0;
+
+        // the synapses sum the multiplicities, so the modulation is passed as one
+        const nest::double_t t_trig = nest::Time( nest::Time::step( now ) ).get_ms();
+        spikes_.assign( 1, nest::spikecounter( t_trig, S_.modulation_ ) );
+        network()->trigger_update_weight( get_gid(), spikes_, t_trig );
+    }
+
+    void modulation_rate::get_status( DictionaryDatum& d ) const
+    {
+        P_.get( d );
+        def< nest::double_t >( d, "modulation", S_.modulation_ );
+    }
+
+    void modulation_rate::set_status( const DictionaryDatum& d )
+    {
+        Parameters_ ptmp = P_;
+        ptmp.set( d );
+        P_ = ptmp;
+    }
+
+} // namespace mynest
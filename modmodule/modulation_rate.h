@@ -0,0 +1,134 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+/*
+ *  The modulation_rate node feeds the modulatory synapses with a continuous 
+ *  modulation, without converting it into spikes. Once per deliver interval
+ *  it triggers the synapses bound to it through "vt" with
+ *
+ *  modulation = rate + gain*(mean input current over the interval)
+ *
+ *  The rate can be set between simulations, and any device sending currents 
+ *  (step_current_generator, ac_generator, noise_generator, ...) can be 
+ *  connected to drive it within a simulation. The modulation is taken by the
+ *  synapses as it is, in place of their normalised ratio of spikes.
+ *
+ *  Parameters:
+ *      rate => modulation without input
+ *      gain => modulation per unit of input current
+ *      deliver_interval => trigger period, in multiples of min_delay
+ *      modulation => modulation passed at the last trigger (read only)
+ */
+
+#ifndef MODULATION_RATE_H
+#define MODULATION_RATE_H
+
+#include "event.h"
+#include "nest_time.h"
+#include "dictdatum.h"
+#include "ring_buffer.h"
+#include "modulation_signal.h"
+
+namespace mynest
+{
+
+    class modulation_rate : public ModulationSignal
+    {
+        public:
+
+            modulation_rate();
+            modulation_rate( const modulation_rate& );
+
+            /**
+             * The node receives from the devices and neurons of its own 
+             * process, as any local target: the kernel refuses to connect 
+             * devices to global receivers such as the volume transmitter.
+             * With MPI each process has its own node, driven by its own
+             * instances of the generators.
+             */
+            bool local_receiver() const
+            {
+                return true;
+            }
+
+            using nest::Node::handle;
+            using nest::Node::handles_test_event;
+
+            void handle( nest::CurrentEvent& e );
+
+            nest::port handles_test_event( nest::CurrentEvent&, nest::rport receptor_type );
+
+            void get_status( DictionaryDatum& d ) const;
+            void set_status( const DictionaryDatum& d );
+
+        private:
+
+            void init_state_( const nest::Node& proto );
+            void init_buffers_();
+            void calibrate();
+
+            void update( nest::Time const&, const nest::long_t, const nest::long_t );
+
+            // ------------------------------------------------------------
+
+            struct Parameters_
+            {
+                nest::double_t rate_;
+                nest::double_t gain_;
+                nest::long_t deliver_interval_;
+
+                Parameters_();
+
+                void get( DictionaryDatum& ) const;
+                void set( const DictionaryDatum& );
+            };
+
+            // ------------------------------------------------------------
+
+            struct State_
+            {
+                nest::double_t input_sum_; //!< input current summed since the last trigger
+                nest::long_t num_steps_; //!< steps since the last trigger
+                nest::double_t modulation_; //!< modulation passed at the last trigger
+
+                State_();
+            };
+
+            // ------------------------------------------------------------
+
+            struct Buffers_
+            {
+                nest::RingBuffer input_; //!< input current of each step
+            };
+
+            Parameters_ P_;
+            State_ S_;
+            Buffers_ B_;
+    };
+
+} // namespace mynest
+
+#endif // MODULATION_RATE_H
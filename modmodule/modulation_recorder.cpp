@@ -0,0 +1,286 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+#include "network.h"
+#include "dictdatum.h"
+#include "dictutils.h"
+#include "arraydatum.h"
+#include "stringdatum.h"
+#include "communicator.h"
+#include "exceptions.h"
+#include "nestmodule.h"
+#include "modulatory_connection.h"
+#include "modulation_recorder.h"
+
+#include <cstdint>
+#include <limits>
+#include <sstream>
+
+namespace mynest
+{
+    //
+    // Implementation of class modulation_recorder::Parameters_.
+    //
+
+    modulation_recorder::Parameters_::Parameters_()
+        : vt_( -1 ),
+        to_file_( false ),
+        binary_( false ),
+        filename_(),
+        record_response_( false )
+    {
+    }
+
+    void modulation_recorder::Parameters_::get( DictionaryDatum& d ) const
+    {
+        def< nest::long_t >( d, "vt", vt_ );
+        def< std::string >( d, "record_to", to_file_ ? "file" : "memory" );
+        def< std::string >( d, "file_format", binary_ ? "binary" : "csv" );
+        def< std::string >( d, "filename", filename_ );
+        def< bool >( d, "record_response", record_response_ );
+    }
+
+    void modulation_recorder::Parameters_::set( const DictionaryDatum& d )
+    {
+        updateValue< nest::long_t >( d, "vt", vt_ );
+        updateValue< std::string >( d, "filename", filename_ );
+        updateValue< bool >( d, "record_response", record_response_ );
+
+        std::string record_to;
+        if ( updateValue< std::string >( d, "record_to", record_to ) )
+        {
+            if ( record_to != "memory" and record_to != "file" )
+                throw nest::BadProperty( "record_to must be \"memory\" or \"file\"." );
+            to_file_ = ( record_to == "file" );
+        }
+
+        std::string file_format;
+        if ( updateValue< std::string >( d, "file_format", file_format ) )
+        {
+            if ( file_format != "csv" and file_format != "binary" )
+                throw nest::BadProperty( "file_format must be \"csv\" or \"binary\"." );
+            binary_ = ( file_format == "binary" );
+        }
+    }
+
+    //
+    // Implementation of class modulation_recorder::State_.
+    //
+
+    modulation_recorder::State_::State_()
+        : n_events_( 0 )
+    {
+    }
+
+    void modulation_recorder::State_::clear()
+    {
+        times_.clear();
+        models_.clear();
+        num_spikes_.clear();
+        modulation_.clear();
+        response_.clear();
+        n_events_ = 0;
+    }
+
+    //
+    // Implementation of class modulation_recorder.
+    //
+
+    modulation_recorder::modulation_recorder()
+        : nest::Node(),
+        P_(),
+        S_(),
+        cache_( 0 )
+    {
+    }
+
+    modulation_recorder::modulation_recorder( const modulation_recorder& n )
+        : nest::Node( n ),
+        P_( n.P_ ),
+        S_(),
+        cache_( 0 )
+    {
+    }
+
+    modulation_recorder::~modulation_recorder()
+    {
+        detach();
+    }
+
+    void modulation_recorder::init_state_( const nest::Node& )
+    {
+    }
+
+    void modulation_recorder::init_buffers_()
+    {
+        S_.clear();
+    }
+
+    void modulation_recorder::calibrate()
+    {
+        // prototypes (gid 0) never record 
+        if ( get_gid() == 0 )
+            return;
+
+        attach();
+
+        if ( P_.to_file_ and not file_.is_open() )
+        {
+            const std::string filename = get_filename();
+            if ( P_.binary_ )
+                file_.open( filename.c_str(), std::ios::binary );
+            else
+                file_.open( filename.c_str() );
+
+            if ( not file_.good() )
+                throw nest::BadProperty( "Could not open " + filename + " for writing." );
+
+            if ( not P_.binary_ )
+                file_ << "time,model,num_spikes,modulation,response\n";
+        }
+    }
+
+    void modulation_recorder::finalize()
+    {
+        if ( file_.is_open() )
+            file_.flush();
+    }
+
+    void modulation_recorder::attach()
+    {
+        if ( P_.vt_ < 0 )
+            return;
+        
+        ModulationCache* cache = ModulationCache::get_cache( P_.vt_ );
+        if ( cache == cache_ )
+            return;
+
+        detach();
+        cache_ = cache;
+        cache_->add_recorder( this );
+    }
+
+    void modulation_recorder::detach()
+    {
+        if ( cache_ != 0 )
+            cache_->remove_recorder( this );
+        cache_ = 0;
+    }
+
+    std::string modulation_recorder::get_filename() const
+    {
+        std::ostringstream filename;
+        if ( P_.filename_.empty() )
+            filename << "modulation_recorder-" << get_gid() 
+                << ( P_.binary_ ? ".dat" : ".csv" );
+        else
+            filename << P_.filename_;
+
+        // each MPI rank records its own synapses 
+        if ( nest::Communicator::get_num_processes() > 1 )
+            filename << "." << nest::Communicator::get_rank();
+
+        return filename.str();
+    }
+
+    void modulation_recorder::record( nest::double_t t_trig, 
+            const std::string& model,
+            nest::double_t num_spikes,
+            nest::double_t modulation,
+            nest::double_t response )
+    {
+        if ( not P_.record_response_ )
+            response = std::numeric_limits< nest::double_t >::quiet_NaN();
+
+        ++S_.n_events_;
+
+        if ( not P_.to_file_ )
+        {
+            S_.times_.push_back( t_trig );
+            S_.models_.push_back( model );
+            S_.num_spikes_.push_back( num_spikes );
+            S_.modulation_.push_back( modulation );
+            S_.response_.push_back( response );
+        }
+        else if ( P_.binary_ )
+        {
+            // time, num_spikes, modulation, response, name length, name 
+            const nest::double_t values[ 4 ] = { t_trig, num_spikes, modulation, response };
+            const std::uint32_t length = model.size();
+            file_.write( reinterpret_cast< const char* >( values ), sizeof( values ) );
+            file_.write( reinterpret_cast< const char* >( &length ), sizeof( length ) );
+            file_.write( model.data(), length );
+        }
+        else
+        {
+            file_ << t_trig << "," << model << "," << num_spikes << "," 
+                << modulation << "," << response << "\n";
+        }
+    }
+
+    void modulation_recorder::get_status( DictionaryDatum& d ) const
+    {
+        P_.get( d );
+        def< nest::long_t >( d, "n_events", S_.n_events_ );
+
+        DictionaryDatum events( new Dictionary );
+        ArrayDatum models;
+        for ( const auto & model: S_.models_ )
+            models.push_back( new StringDatum( model ) );
+        def< std::vector< nest::double_t > >( events, "times", S_.times_ );
+        def< ArrayDatum >( events, "models", models );
+        def< std::vector< nest::double_t > >( events, "num_spikes", S_.num_spikes_ );
+        def< std::vector< nest::double_t > >( events, "modulation", S_.modulation_ );
+        def< std::vector< nest::double_t > >( events, "response", S_.response_ );
+        def< DictionaryDatum >( d, "events", events );
+    }
+
+    void modulation_recorder::set_status( const DictionaryDatum& d )
+    {
+        Parameters_ ptmp = P_;
+        ptmp.set( d );
+
+        nest::long_t n_events = S_.n_events_;
+        if ( updateValue< nest::long_t >( d, "n_events", n_events ) )
+        {
+            if ( n_events != 0 )
+                throw nest::BadProperty( "n_events can only be set to 0." );
+            S_.clear();
+        }
+
+        // the file is opened again at the next simulation
+        if ( ptmp.to_file_ != P_.to_file_ or ptmp.binary_ != P_.binary_ 
+                or ptmp.filename_ != P_.filename_ )
+            file_.close();
+
+        // the new volume transmitter is bound at the next simulation
+        if ( ptmp.vt_ != P_.vt_ )
+            detach();
+
+        P_ = ptmp;
+    }
+
+} // namespace mynest
@@ -0,0 +1,160 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+/*
+ *  The modulation_recorder device records the modulation seen by the synapses
+ *  bound to one volume transmitter, once per trigger.
+ *
+ *  For each synapse model bound to the volume transmitter it records the
+ *  trigger time, the sum of the modulatory spikes, the normalised modulation
+ *  (after the dose-response function) and, if record_response is set, the
+ *  value of the modulation law f(modulation) for the first synapse of the
+ *  model that was triggered, which is the value of every synapse of the model 
+ *  when their law parameters are homogeneous.
+ *
+ *  The samples are published by the synapses through the ModulationCache of 
+ *  the volume transmitter, so that nothing is computed twice and nothing 
+ *  at all is done for volume transmitters without recorders.
+ *
+ *  Parameters:
+ *      vt => gid of the volume transmitter to record from
+ *      record_to => "memory" (default) or "file"
+ *      file_format => "csv" (default) or "binary"
+ *      filename => name of the file, by default modulation_recorder-<gid>.<csv|dat>
+ *      record_response => also record f(modulation), default false
+ *      events => dictionary with the recorded times, models, num_spikes, 
+ *          modulation and response (memory only)
+ *      n_events => number of recorded samples, set it to 0 to clear them
+ */
+
+#ifndef MODULATION_RECORDER_H
+#define MODULATION_RECORDER_H
+
+#include "node.h"
+#include "nest_time.h"
+#include "dictdatum.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace mynest
+{
+    class ModulationCache;
+
+    class modulation_recorder : public nest::Node
+    {
+        public:
+
+            modulation_recorder();
+            modulation_recorder( const modulation_recorder& );
+            ~modulation_recorder();
+
+            //! The recorder is not connected to anything and exists once per process
+            bool has_proxies() const
+            {
+                return false;
+            }
+
+            bool one_node_per_process() const
+            {
+                return true;
+            }
+
+            void get_status( DictionaryDatum& d ) const;
+            void set_status( const DictionaryDatum& d );
+
+            /**
+             * Store one sample. Called by the ModulationCache of the 
+             * recorded volume transmitter, never concurrently.
+             */
+            void record( nest::double_t t_trig, 
+                    const std::string& model,
+                    nest::double_t num_spikes,
+                    nest::double_t modulation,
+                    nest::double_t response );
+
+        private:
+
+            void init_state_( const nest::Node& proto );
+            void init_buffers_();
+            void calibrate();
+            void finalize();
+
+            //! Samples are pushed by the synapses, there is nothing to update
+            void update( nest::Time const&, const nest::long_t, const nest::long_t )
+            {
+            }
+
+            //! Bind the recorder to the cache of P_.vt_, unbinding it from the previous one
+            void attach();
+            void detach();
+
+            std::string get_filename() const;
+
+            // ------------------------------------------------------------
+
+            struct Parameters_
+            {
+                nest::long_t vt_; //!< gid of the recorded volume transmitter
+                bool to_file_; //!< stream the samples to a file instead of memory
+                bool binary_; //!< binary instead of csv file
+                std::string filename_; //!< file name, empty for the default one
+                bool record_response_; //!< record f(modulation)
+
+                Parameters_();
+
+                void get( DictionaryDatum& ) const;
+                void set( const DictionaryDatum& );
+            };
+
+            // ------------------------------------------------------------
+
+            struct State_
+            {
+                std::vector< nest::double_t > times_;
+                std::vector< std::string > models_;
+                std::vector< nest::double_t > num_spikes_;
+                std::vector< nest::double_t > modulation_;
+                std::vector< nest::double_t > response_;
+                nest::long_t n_events_; //!< samples recorded, also those written to file
+
+                State_();
+
+                void clear();
+            };
+
+            // ------------------------------------------------------------
+
+            Parameters_ P_;
+            State_ S_;
+
+            ModulationCache* cache_; //!< cache the recorder is attached to
+            std::ofstream file_; //!< output stream when recording to file
+    };
+
+} // namespace mynest
+
+#endif // MODULATION_RECORDER_H
@@ -0,0 +1,162 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+#include "network.h"
+#include "communicator.h"
+#include "dictdatum.h"
+#include "dictutils.h"
+#include "exceptions.h"
+#include "modulation_reducer.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace mynest
+{
+    //
+    // Implementation of class modulation_reducer::Parameters_ and State_.
+    //
+
+    modulation_reducer::Parameters_::Parameters_()
+        : deliver_interval_( 1 )
+    {
+    }
+
+    void modulation_reducer::Parameters_::get( DictionaryDatum& d ) const
+    {
+        def< nest::long_t >( d, "deliver_interval", deliver_interval_ );
+    }
+
+    void modulation_reducer::Parameters_::set( const DictionaryDatum& d )
+    {
+        updateValue< nest::long_t >( d, "deliver_interval", deliver_interval_ );
+        if ( deliver_interval_ < 1 )
+            throw nest::BadProperty( "deliver_interval must be positive." );
+    }
+
+    modulation_reducer::State_::State_()
+        : local_spikes_( 0.0 ),
+        num_spikes_( 0.0 )
+    {
+    }
+
+    //
+    // Implementation of class modulation_reducer.
+    //
+
+    modulation_reducer::modulation_reducer()
+        : ModulationSignal( false ),
+        P_(),
+        S_(),
+        B_()
+    {
+    }
+
+    modulation_reducer::modulation_reducer( const modulation_reducer& n )
+        : ModulationSignal( n ),
+        P_( n.P_ ),
+        S_(),
+        B_()
+    {
+    }
+
+    void modulation_reducer::init_state_( const nest::Node& )
+    {
+        S_ = State_();
+    }
+
+    void modulation_reducer::init_buffers_()
+    {
+        B_.spikes_.resize( network()->get_num_threads() );
+        for ( auto & buffer: B_.spikes_ )
+            buffer.clear();
+        B_.count_.assign( 1, 0.0 );
+        spikes_.clear();
+    }
+
+    void modulation_reducer::calibrate()
+    {
+    }
+
+    nest::port modulation_reducer::handles_test_event( nest::SpikeEvent&, nest::rport receptor_type )
+    {
+        if ( receptor_type != 0 )
+            throw nest::UnknownReceptorType( receptor_type, get_name() );
+        return 0;
+    }
+
+    void modulation_reducer::handle( nest::SpikeEvent& e )
+    {
+        // called by the thread of the sender, which writes only its own buffer
+#ifdef _OPENMP
+        const nest::thread t = omp_get_thread_num();
+#else
+        const nest::thread t = 0;
+#endif
+        B_.spikes_[ t ].add_value( e.get_rel_delivery_steps( network()->get_slice_origin() ),
+                e.get_multiplicity() );
+    }
+
+    void modulation_reducer::update( nest::Time const& origin, const nest::long_t from, const nest::long_t to )
+    {
+        // spikes count in the interval of their delivery step
+        for ( nest::long_t lag = from; lag < to; ++lag )
+            for ( auto & buffer: B_.spikes_ )
+                B_.count_[ 0 ] += buffer.get_value( lag );
+
+        const nest::long_t now = origin.get_steps() + to;
+        const nest::long_t interval = P_.deliver_interval_*network()->get_min_delay();
+        if ( now % interval != 0 )
+            return;
+
+        S_.local_spikes_ = B_.count_[ 0 ];
+        if ( nest::Communicator::get_num_processes() > 1 )
+            nest::Communicator::communicate_Allreduce_sum_in_place( B_.count_ );
+        S_.num_spikes_ = B_.count_[ 0 ];
+        B_.count_[ 0 ] = 0.0;
+
+        // the synapses sum the multiplicities, so the count is passed as one spike
+        const nest::double_t t_trig = nest::Time( nest::Time::step( now ) ).get_ms();
+        spikes_.assign( 1, nest::spikecounter( t_trig, S_.num_spikes_ ) );
+        network()->trigger_update_weight( get_gid(), spikes_, t_trig );
+    }
+
+    void modulation_reducer::get_status( DictionaryDatum& d ) const
+    {
+        P_.get( d );
+        def< nest::double_t >( d, "local_spikes", S_.local_spikes_ );
+        def< nest::double_t >( d, "num_spikes", S_.num_spikes_ );
+    }
+
+    void modulation_reducer::set_status( const DictionaryDatum& d )
+    {
+        Parameters_ ptmp = P_;
+        ptmp.set( d );
+        P_ = ptmp;
+    }
+
+} // namespace mynest
@@ -0,0 +1,146 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+/*
+ *  The modulation_reducer node replaces the volume transmitter when the 
+ *  network is distributed over several MPI processes. 
+ *
+ *  A volume transmitter exists on every process and each one must receive 
+ *  every modulatory spike. The reducer, instead, is only connected to the 
+ *  modulatory neurons local to its process, counts their spikes and, once 
+ *  per deliver interval, sums the counts of all processes with a single 
+ *  allreduce of one value. The synapses bound to it through "vt" are triggered with the 
+ *  global count, which they normalise with max_modulation as the spikes 
+ *  of a volume transmitter, so the modulatory traffic scales with the 
+ *  number of intervals rather than with the number of spikes.
+ *
+ *  Since the count carries no spike times, with tau_modulation all the 
+ *  spikes of an interval are taken at the trigger time.
+ *
+ *  The spikes of local neurons are delivered by the threads of their 
+ *  sources, at the same time, so each thread counts them in its own ring
+ *  buffer, at their delivery step; the counts of the steps of an interval 
+ *  are summed by update().
+ *
+ *  The reduction is a collective operation: every process calls it at the
+ *  same intervals, from the thread holding the node, which for nodes with 
+ *  one instance per process is the master thread.
+ *
+ *  Parameters:
+ *      deliver_interval => trigger period, in multiples of min_delay
+ *      local_spikes => spikes counted on this process in the last interval (read only)
+ *      num_spikes => spikes counted on all processes in the last interval (read only)
+ */
+
+#ifndef MODULATION_REDUCER_H
+#define MODULATION_REDUCER_H
+
+#include "event.h"
+#include "nest_time.h"
+#include "dictdatum.h"
+#include "ring_buffer.h"
+#include "modulation_signal.h"
+#include <vector>
+
+namespace mynest
+{
+
+    class modulation_reducer : public ModulationSignal
+    {
+        public:
+
+            modulation_reducer();
+            modulation_reducer( const modulation_reducer& );
+
+            /**
+             * Unlike the volume transmitter, the reducer receives the spikes 
+             * of its own process only: the kernel does not connect it to 
+             * the proxies of remote neurons.
+             */
+            bool local_receiver() const
+            {
+                return true;
+            }
+
+            using nest::Node::handle;
+            using nest::Node::handles_test_event;
+
+            void handle( nest::SpikeEvent& e );
+
+            nest::port handles_test_event( nest::SpikeEvent&, nest::rport receptor_type );
+
+            void get_status( DictionaryDatum& d ) const;
+            void set_status( const DictionaryDatum& d );
+
+        private:
+
+            void init_state_( const nest::Node& proto );
+            void init_buffers_();
+            void calibrate();
+
+            void update( nest::Time const&, const nest::long_t, const nest::long_t );
+
+            // ------------------------------------------------------------
+
+            struct Parameters_
+            {
+                nest::long_t deliver_interval_;
+
+                Parameters_();
+
+                void get( DictionaryDatum& ) const;
+                void set( const DictionaryDatum& );
+            };
+
+            // ------------------------------------------------------------
+
+            struct State_
+            {
+                nest::double_t local_spikes_; //!< local spikes of the last interval
+                nest::double_t num_spikes_; //!< global spikes of the last interval
+
+                State_();
+            };
+
+            // ------------------------------------------------------------
+
+            struct Buffers_
+            {
+                //! local spikes of each delivery step, one buffer per thread
+                std::vector< nest::RingBuffer > spikes_;
+
+                //! local spikes of the current interval, the buffer of the allreduce
+                std::vector< nest::double_t > count_;
+            };
+
+            Parameters_ P_;
+            State_ S_;
+            Buffers_ B_;
+    };
+
+} // namespace mynest
+
+#endif // MODULATION_REDUCER_H
@@ -0,0 +1,253 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+#include "network.h"
+#include "dictdatum.h"
+#include "dictutils.h"
+#include "exceptions.h"
+#include "modulation_replay.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mynest
+{
+    //
+    // Implementation of class modulation_replay::Parameters_.
+    //
+
+    modulation_replay::Parameters_::Parameters_()
+        : filename_(),
+        binary_( true ),
+        deliver_interval_( 1 )
+    {
+    }
+
+    void modulation_replay::Parameters_::get( DictionaryDatum& d ) const
+    {
+        def< std::string >( d, "filename", filename_ );
+        def< std::string >( d, "file_format", binary_ ? "binary" : "csv" );
+        def< nest::long_t >( d, "deliver_interval", deliver_interval_ );
+    }
+
+    void modulation_replay::Parameters_::set( const DictionaryDatum& d )
+    {
+        updateValue< std::string >( d, "filename", filename_ );
+
+        std::string format;
+        if ( updateValue< std::string >( d, "file_format", format ) )
+        {
+            if ( format != "binary" and format != "csv" )
+                throw nest::BadProperty( "file_format must be \"binary\" or \"csv\"." );
+            binary_ = format == "binary";
+        }
+
+        updateValue< nest::long_t >( d, "deliver_interval", deliver_interval_ );
+        if ( deliver_interval_ < 1 )
+            throw nest::BadProperty( "deliver_interval must be positive." );
+    }
+
+    //
+    // Implementation of class modulation_replay::State_ and Buffers_.
+    //
+
+    modulation_replay::State_::State_()
+        : offset_( 0 ),
+        modulation_( 0.0 ),
+        next_time_( -1.0 ),
+        next_modulation_( 0.0 )
+    {
+    }
+
+    modulation_replay::Buffers_::Buffers_()
+        : map_( 0 ),
+        size_( 0 )
+    {
+    }
+
+    //
+    // Implementation of class modulation_replay.
+    //
+
+    modulation_replay::modulation_replay()
+        : ModulationSignal( true ),
+        P_(),
+        S_(),
+        B_()
+    {
+    }
+
+    // the copy maps its own file at calibration
+    modulation_replay::modulation_replay( const modulation_replay& n )
+        : ModulationSignal( n ),
+        P_( n.P_ ),
+        S_(),
+        B_()
+    {
+    }
+
+    modulation_replay::~modulation_replay()
+    {
+        unmap_file();
+    }
+
+    void modulation_replay::init_state_( const nest::Node& )
+    {
+        S_ = State_();
+    }
+
+    void modulation_replay::init_buffers_()
+    {
+        spikes_.clear();
+    }
+
+    void modulation_replay::calibrate()
+    {
+        if ( B_.map_ == 0 )
+            map_file();
+    }
+
+    void modulation_replay::map_file()
+    {
+        unmap_file();
+        S_ = State_();
+
+        if ( P_.filename_.empty() )
+            throw nest::BadProperty( "The modulation_replay needs a filename." );
+
+        const int fd = open( P_.filename_.c_str(), O_RDONLY );
+        if ( fd < 0 )
+            throw nest::BadProperty( "Could not open " + P_.filename_ + " for reading." );
+        
+        struct stat file_stat;
+        if ( fstat( fd, &file_stat ) != 0 or file_stat.st_size == 0 )
+        {
+            close( fd );
+            throw nest::BadProperty( "Could not read " + P_.filename_ + "." );
+        }
+
+        void* map = mmap( 0, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+        close( fd );
+        if ( map == MAP_FAILED )
+            throw nest::BadProperty( "Could not map " + P_.filename_ + " in memory." );
+        
+        // read once from the beginning to the end
+        madvise( map, file_stat.st_size, MADV_SEQUENTIAL );
+
+        B_.map_ = static_cast< const char* >( map );
+        B_.size_ = file_stat.st_size;
+    }
+
+    void modulation_replay::unmap_file()
+    {
+        if ( B_.map_ != 0 )
+            munmap( const_cast< char* >( B_.map_ ), B_.size_ );
+        B_.map_ = 0;
+        B_.size_ = 0;
+    }
+
+    bool modulation_replay::read_sample( nest::double_t& time, nest::double_t& modulation )
+    {
+        if ( P_.binary_ )
+        {
+            if ( S_.offset_ + 2*sizeof( nest::double_t ) > B_.size_ )
+                return false;
+            std::memcpy( &time, B_.map_ + S_.offset_, sizeof( nest::double_t ) );
+            std::memcpy( &modulation, B_.map_ + S_.offset_ + sizeof( nest::double_t ), 
+                    sizeof( nest::double_t ) );
+            S_.offset_ += 2*sizeof( nest::double_t );
+            return true;
+        }
+
+        while ( S_.offset_ < B_.size_ )
+        {
+            // the mapping is not terminated, parse a copy of the line
+            const char* begin = B_.map_ + S_.offset_;
+            const char* newline = static_cast< const char* >( 
+                    std::memchr( begin, '\n', B_.size_ - S_.offset_ ) );
+            const size_t length = newline != 0 ? newline - begin : B_.size_ - S_.offset_;
+            S_.offset_ += length + 1;
+
+            const std::string line( begin, length );
+            char* end;
+            time = std::strtod( line.c_str(), &end );
+            if ( end == line.c_str() or *end != ',' )
+                continue;
+            const char* value = end + 1;
+            modulation = std::strtod( value, &end );
+            if ( end != value )
+                return true;
+        }
+        return false;
+    }
+
+    void modulation_replay::update( nest::Time const&, const nest::long_t, const nest::long_t to )
+    {
+        const nest::long_t now = network()->get_slice_origin().get_steps() + to;
+        const nest::long_t interval = P_.deliver_interval_*network()->get_min_delay();
+        if ( now % interval != 0 )
+            return;
+
+        const nest::double_t t_trig = nest::Time( nest::Time::step( now ) ).get_ms();
+
+        // hold the last sample up to the trigger, keeping the next one read ahead 
+        if ( S_.next_time_ < 0 and not read_sample( S_.next_time_, S_.next_modulation_ ) )
+            S_.next_time_ = -1.0;
+        while ( S_.next_time_ >= 0 and S_.next_time_ <= t_trig )
+        {
+            S_.modulation_ = S_.next_modulation_;
+            if ( not read_sample( S_.next_time_, S_.next_modulation_ ) )
+                S_.next_time_ = -1.0;
+        }
+
+        // the synapses sum the multiplicities, so the sample is passed as one
+        spikes_.assign( 1, nest::spikecounter( t_trig, S_.modulation_ ) );
+        network()->trigger_update_weight( get_gid(), spikes_, t_trig );
+    }
+
+    void modulation_replay::get_status( DictionaryDatum& d ) const
+    {
+        P_.get( d );
+        def< nest::double_t >( d, "modulation", S_.modulation_ );
+    }
+
+    void modulation_replay::set_status( const DictionaryDatum& d )
+    {
+        Parameters_ ptmp = P_;
+        ptmp.set( d );
+
+        // a new file is replayed from the beginning at the next simulation 
+        if ( ptmp.filename_ != P_.filename_ or ptmp.binary_ != P_.binary_ )
+            unmap_file();
+        P_ = ptmp;
+    }
+
+} // namespace mynest
@@ -0,0 +1,137 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+/*
+ *  The modulation_replay node replaces the modulatory neurons and the volume 
+ *  transmitter when the modulation is given rather than emergent. It streams
+ *  a pre-recorded time series of modulation values and, once per deliver 
+ *  interval, triggers the synapses bound to it with the last sample at or 
+ *  before the trigger time (sample and hold, 0 before the first sample).
+ *
+ *  The file is mapped in memory and read forward as the simulation advances,
+ *  so series larger than the available memory can be replayed. Samples must 
+ *  be sorted by time. The replayed values are already normalised: with the
+ *  linear response they are the ratio of the modulation laws.
+ *
+ *  Synapses are bound to the node with their "vt" parameter, as they are 
+ *  to a volume transmitter.
+ *
+ *  Parameters:
+ *      filename => file with the time series
+ *      file_format => "binary" (pairs of doubles: time in ms, modulation) or 
+ *                     "csv" (time,modulation lines; lines that do not start 
+ *                     with a number, such as a header, are skipped)
+ *      deliver_interval => trigger period, in multiples of min_delay
+ *      modulation => last replayed sample (read only)
+ */
+
+#ifndef MODULATION_REPLAY_H
+#define MODULATION_REPLAY_H
+
+#include "nest_time.h"
+#include "dictdatum.h"
+#include "modulation_signal.h"
+#include <string>
+#include <vector>
+
+namespace mynest
+{
+
+    class modulation_replay : public ModulationSignal
+    {
+        public:
+
+            modulation_replay();
+            modulation_replay( const modulation_replay& );
+            ~modulation_replay();
+
+            void get_status( DictionaryDatum& d ) const;
+            void set_status( const DictionaryDatum& d );
+
+        private:
+
+            void init_state_( const nest::Node& proto );
+            void init_buffers_();
+            void calibrate();
+
+            void update( nest::Time const&, const nest::long_t, const nest::long_t );
+
+            //! Map P_.filename_ in memory and replay it from the beginning
+            void map_file();
+
+            //! Release the mapped file
+            void unmap_file();
+
+            /**
+             * Read the next sample of the mapped file into time and modulation.
+             * Return false at the end of the file.
+             */
+            bool read_sample( nest::double_t& time, nest::double_t& modulation );
+
+            // ------------------------------------------------------------
+
+            struct Parameters_
+            {
+                std::string filename_;
+                bool binary_; //!< binary file, otherwise csv
+                nest::long_t deliver_interval_;
+
+                Parameters_();
+
+                void get( DictionaryDatum& ) const;
+                void set( const DictionaryDatum& );
+            };
+
+            // ------------------------------------------------------------
+
+            struct State_
+            {
+                size_t offset_; //!< bytes of the file already read
+                nest::double_t modulation_; //!< last sample at or before the last trigger
+                nest::double_t next_time_; //!< time of the sample read ahead, -1 if none
+                nest::double_t next_modulation_; //!< value of the sample read ahead
+
+                State_();
+            };
+
+            // ------------------------------------------------------------
+
+            struct Buffers_
+            {
+                const char* map_; //!< mapped file, null if not mapped
+                size_t size_; //!< size of the mapped file
+
+                Buffers_();
+            };
+
+            Parameters_ P_;
+            State_ S_;
+            Buffers_ B_;
+    };
+
+} // namespace mynest
+
+#endif // MODULATION_REPLAY_H
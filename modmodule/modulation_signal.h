@@ -0,0 +1,107 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+/*
+ *  Base of the nodes that take the place of the volume transmitter 
+ *  (modulation_replay, modulation_rate, modulation_reducer).
+ *
+ *  Like a volume transmitter, such a node triggers the synapses bound to it 
+ *  through "vt" once per deliver interval. It passes them a single 
+ *  spikecounter whose multiplicity is either the modulation, already 
+ *  normalised, which the synapses take in place of their ratio of spikes,
+ *  or the count of modulatory spikes of the interval, which they normalise
+ *  as the spikes of a volume transmitter.
+ */
+
+#ifndef MODULATION_SIGNAL_H
+#define MODULATION_SIGNAL_H
+
+#include "node.h"
+#include "spikecounter.h"
+#include <vector>
+
+namespace mynest
+{
+
+    class ModulationSignal : public nest::Node
+    {
+        public:
+
+            //! @param normalised true if the node passes the modulation, false if it passes spike counts 
+            explicit ModulationSignal( bool normalised )
+                : nest::Node()
+                  ,normalised_( normalised )
+            {
+            }
+
+            //! The buffer is not copied, each node fills its own
+            ModulationSignal( const ModulationSignal& n )
+                : nest::Node( n )
+                  ,normalised_( n.normalised_ )
+            {
+            }
+
+            //! Like the volume transmitter, the signal exists once per process
+            bool has_proxies() const
+            {
+                return false;
+            }
+
+            bool local_receiver() const
+            {
+                return false;
+            }
+
+            bool one_node_per_process() const
+            {
+                return true;
+            }
+
+            //! Buffer passed to the triggered synapses, as volume_transmitter::deliver_spikes()
+            const std::vector< nest::spikecounter >& deliver_spikes() const
+            {
+                return spikes_;
+            }
+
+            //! True if the node passes the modulation rather than spike counts
+            bool is_normalised() const
+            {
+                return normalised_;
+            }
+
+        protected:
+
+            //! holds the modulation passed to the triggered synapses
+            std::vector< nest::spikecounter > spikes_;
+
+        private:
+
+            bool normalised_;
+    };
+
+} // namespace mynest
+
+#endif // MODULATION_SIGNAL_H
@@ -0,0 +1,547 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+#include "network.h"
+#include "dictdatum.h"
+#include "arraydatum.h"
+#include "booldatum.h"
+#include "doubledatum.h"
+#include "integerdatum.h"
+#include "namedatum.h"
+#include "stringdatum.h"
+#include "connectiondatum.h"
+#include "communicator.h"
+#include "exceptions.h"
+#include "nestmodule.h"
+#include "modulatory_checkpoint.h"
+
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace mynest
+{
+    namespace
+    {
+        const char checkpoint_magic[ 8 ] = { 'M', 'O', 'D', 'C', 'K', 'P', 'T', '2' };
+
+        /**
+         * Fixed size record of one synapse in the checkpoint file.
+         * Parameters the model does not have are stored as NaN.
+         */
+        struct CheckpointRecord
+        {
+            nest::long_t source_;
+            nest::long_t target_;
+            nest::long_t model_; //!< index in the model table of the file
+            nest::long_t receptor_;
+            nest::long_t deliver_interval_;
+            nest::double_t delay_;
+            nest::double_t weight_baseline_;
+            nest::double_t alpha_;
+            nest::double_t weight_;
+        };
+
+        /**
+         * A model whose common properties are ModulatoryCommonProperties,
+         * with its defaults.
+         */
+        struct CheckpointModel
+        {
+            std::string name_;
+            nest::index syn_id_;
+            DictionaryDatum defaults_;
+        };
+
+        /**
+         * Entries of the defaults that are not restored: they are computed
+         * by the kernel (num_connections, size_of, synapse_model, the delay
+         * extrema), refused by set_status (the weight of the "_hom" models)
+         * or only reported (the counters of instrument).
+         */
+        bool is_restored( const Name& key )
+        {
+            static const char* const skipped[] = { "num_connections", "size_of", 
+                "synapse_model", "min_delay", "max_delay", "weight", "num_triggers", 
+                "synapses_per_trigger", "updates_per_trigger", "trigger_time", 
+                "max_trigger_time", "num_spikes_sent", "modulation_min", 
+                "modulation_mean", "modulation_max" };
+            const std::string name = key.toString();
+            for ( size_t i = 0; i < sizeof( skipped )/sizeof( skipped[ 0 ] ); ++i )
+                if ( name == skipped[ i ] )
+                    return false;
+            return true;
+        }
+
+        //! Each MPI rank has its own file 
+        std::string rank_filename( const std::string& filename )
+        {
+            if ( nest::Communicator::get_num_processes() == 1 )
+                return filename;
+
+            std::ostringstream rank_name;
+            rank_name << filename << "." << nest::Communicator::get_rank();
+            return rank_name.str();
+        }
+
+        //! Modulatory models are the ones with max_modulation in their defaults
+        std::vector< CheckpointModel > get_modulatory_models( nest::Network& net )
+        {
+            std::vector< CheckpointModel > models;
+            
+            const Dictionary& synapsedict = net.get_synapsedict();
+            for ( Dictionary::const_iterator it = synapsedict.begin(); 
+                    it != synapsedict.end(); ++it )
+            {
+                const nest::index syn_id = getValue< nest::long_t >( it->second );
+                DictionaryDatum defaults = net.get_synapse_defaults( syn_id );
+                if ( not defaults->known( "max_modulation" ) )
+                    continue;
+
+                CheckpointModel model;
+                model.name_ = it->first.toString();
+                model.syn_id_ = syn_id;
+                model.defaults_ = defaults;
+                models.push_back( model );
+            }
+
+            return models;
+        }
+
+        /**
+         * Keys of the synapse dictionaries. Names are entered in the global
+         * table of SLI, which is not thread safe, so they are created
+         * before the parallel regions.
+         */
+        struct CheckpointNames
+        {
+            CheckpointNames()
+                : target_( "target" ),
+                receptor_( "receptor" ),
+                receptor_type_( "receptor_type" ),
+                deliver_interval_( "deliver_interval" ),
+                delay_( "delay" ),
+                weight_baseline_( "weight_baseline" ),
+                alpha_( "alpha" ),
+                weight_( "weight" )
+            {
+            }
+
+            const Name target_;
+            const Name receptor_;
+            const Name receptor_type_;
+            const Name deliver_interval_;
+            const Name delay_;
+            const Name weight_baseline_;
+            const Name alpha_;
+            const Name weight_;
+        };
+
+        nest::double_t get_or_nan( const DictionaryDatum& d, const Name& n )
+        {
+            if ( d->known( n ) )
+                return getValue< nest::double_t >( d, n );
+            return std::numeric_limits< nest::double_t >::quiet_NaN();
+        }
+
+        template < typename T >
+            void write_value( std::ofstream& out, const T& value )
+            {
+                out.write( reinterpret_cast< const char* >( &value ), sizeof( T ) );
+            }
+
+        template < typename T >
+            T read_value( const char*& p, const char* end )
+            {
+                if ( p + sizeof( T ) > end )
+                    throw nest::BadProperty( "Truncated modulatory checkpoint file." );
+                T value;
+                std::memcpy( &value, p, sizeof( T ) );
+                p += sizeof( T );
+                return value;
+            }
+
+        void write_string( std::ofstream& out, const std::string& s )
+        {
+            write_value< nest::long_t >( out, s.size() );
+            out.write( s.data(), s.size() );
+        }
+
+        std::string read_string( const char*& p, const char* end )
+        {
+            const nest::long_t length = read_value< nest::long_t >( p, end );
+            if ( length < 0 or p + length > end )
+                throw nest::BadProperty( "Truncated modulatory checkpoint file." );
+            const std::string s( p, length );
+            p += length;
+            return s;
+        }
+
+        /**
+         * Write the entries of d as name, type and value. The common 
+         * properties only hold integers, doubles, booleans, strings and
+         * arrays of doubles, entries of other types are not written.
+         */
+        void write_dictionary( std::ofstream& out, const DictionaryDatum& d )
+        {
+            std::vector< std::pair< std::string, Token > > entries;
+            for ( Dictionary::const_iterator it = d->begin(); it != d->end(); ++it )
+                if ( is_restored( it->first ) )
+                    entries.push_back( std::make_pair( it->first.toString(), it->second ) );
+
+            std::ostringstream values( std::ios::binary );
+            nest::long_t num_entries = 0;
+            for ( size_t i = 0; i < entries.size(); ++i )
+            {
+                Datum* datum = entries[ i ].second.datum();
+                char type;
+                std::string value;
+                if ( dynamic_cast< BoolDatum* >( datum ) )
+                {
+                    type = 'b';
+                    value.assign( 1, getValue< bool >( entries[ i ].second ) ? 1 : 0 );
+                }
+                else if ( dynamic_cast< IntegerDatum* >( datum ) )
+                {
+                    type = 'i';
+                    const nest::long_t v = getValue< nest::long_t >( entries[ i ].second );
+                    value.assign( reinterpret_cast< const char* >( &v ), sizeof( v ) );
+                }
+                else if ( dynamic_cast< DoubleDatum* >( datum ) )
+                {
+                    type = 'd';
+                    const nest::double_t v = getValue< nest::double_t >( entries[ i ].second );
+                    value.assign( reinterpret_cast< const char* >( &v ), sizeof( v ) );
+                }
+                else if ( dynamic_cast< StringDatum* >( datum ) 
+                        or dynamic_cast< LiteralDatum* >( datum ) )
+                {
+                    type = 's';
+                    const std::string v = getValue< std::string >( entries[ i ].second );
+                    const nest::long_t length = v.size();
+                    value.assign( reinterpret_cast< const char* >( &length ), sizeof( length ) );
+                    value += v;
+                }
+                else if ( dynamic_cast< ArrayDatum* >( datum ) )
+                {
+                    type = 'v';
+                    const std::vector< nest::double_t > v = 
+                        getValue< std::vector< nest::double_t > >( entries[ i ].second );
+                    const nest::long_t length = v.size();
+                    value.assign( reinterpret_cast< const char* >( &length ), sizeof( length ) );
+                    value.append( reinterpret_cast< const char* >( v.data() ), 
+                            v.size()*sizeof( nest::double_t ) );
+                }
+                else
+                    continue;
+
+                const nest::long_t length = entries[ i ].first.size();
+                values.write( reinterpret_cast< const char* >( &length ), sizeof( length ) );
+                values << entries[ i ].first << type << value;
+                ++num_entries;
+            }
+
+            write_value< nest::long_t >( out, num_entries );
+            out << values.str();
+        }
+
+        DictionaryDatum read_dictionary( const char*& p, const char* end )
+        {
+            DictionaryDatum d( new Dictionary );
+            const nest::long_t num_entries = read_value< nest::long_t >( p, end );
+            for ( nest::long_t i = 0; i < num_entries; ++i )
+            {
+                const std::string key = read_string( p, end );
+                switch ( read_value< char >( p, end ) )
+                {
+                    case 'b':
+                        def< bool >( d, key, read_value< char >( p, end ) != 0 );
+                        break;
+                    case 'i':
+                        def< nest::long_t >( d, key, read_value< nest::long_t >( p, end ) );
+                        break;
+                    case 'd':
+                        def< nest::double_t >( d, key, read_value< nest::double_t >( p, end ) );
+                        break;
+                    case 's':
+                        def< std::string >( d, key, read_string( p, end ) );
+                        break;
+                    case 'v':
+                    {
+                        const nest::long_t length = read_value< nest::long_t >( p, end );
+                        if ( length < 0 )
+                            throw nest::BadProperty( "Corrupted modulatory checkpoint file." );
+                        std::vector< nest::double_t > v( length );
+                        for ( nest::long_t j = 0; j < length; ++j )
+                            v[ j ] = read_value< nest::double_t >( p, end );
+                        def< std::vector< nest::double_t > >( d, key, v );
+                        break;
+                    }
+                    default:
+                        throw nest::BadProperty( "Corrupted modulatory checkpoint file." );
+                }
+            }
+            return d;
+        }
+
+        nest::thread get_omp_thread()
+        {
+#ifdef _OPENMP
+            return omp_get_thread_num();
+#else
+            return 0;
+#endif
+        }
+    }
+
+    nest::long_t save_modulatory_synapses( const std::string& filename )
+    {
+        nest::Network& net = nest::NestModule::get_network();
+        const nest::thread num_threads = net.get_num_threads();
+        const std::vector< CheckpointModel > models = get_modulatory_models( net );
+
+        // the connections of every model, sorted by the thread of their target
+        std::vector< std::vector< std::pair< nest::ConnectionID, nest::long_t > > > 
+            connections( num_threads );
+        for ( size_t m = 0; m < models.size(); ++m )
+        {
+            DictionaryDatum params( new Dictionary );
+            def< LiteralDatum >( params, nest::names::synapse_model, LiteralDatum( models[ m ].name_ ) );
+            
+            ArrayDatum conns = net.get_connections( params );
+
+            // the traces of the STDP models live in the synapses and in the
+            // spike history of their targets, which can not be restored
+            if ( conns.size() > 0 and models[ m ].defaults_->known( "tau_c" ) )
+                throw nest::BadProperty( "The synapses of " + models[ m ].name_ + 
+                        " can not be checkpointed: the STDP traces are not saved." );
+
+            for ( size_t i = 0; i < conns.size(); ++i )
+            {
+                ConnectionDatum* conn = dynamic_cast< ConnectionDatum* >( conns[ i ].datum() );
+                connections[ conn->get_target_thread() ].push_back( std::make_pair( *conn, m ) );
+            }
+        }
+
+        // each thread reads the status of the synapses it owns
+        const CheckpointNames names;
+        std::vector< std::vector< CheckpointRecord > > records( num_threads );
+        std::vector< std::exception_ptr > errors( num_threads );
+#pragma omp parallel
+        {
+            const nest::thread t = get_omp_thread();
+            try
+            {
+                records[ t ].resize( connections[ t ].size() );
+                for ( size_t i = 0; i < connections[ t ].size(); ++i )
+                {
+                    const nest::ConnectionID& conn = connections[ t ][ i ].first;
+                    DictionaryDatum status = net.get_synapse_status( conn.get_source_gid(), 
+                            conn.get_synapse_model_id(), conn.get_port(), t );
+
+                    CheckpointRecord& record = records[ t ][ i ];
+                    record.source_ = conn.get_source_gid();
+                    record.target_ = getValue< nest::long_t >( status, names.target_ );
+                    record.model_ = connections[ t ][ i ].second;
+                    record.receptor_ = status->known( names.receptor_ ) 
+                        ? getValue< nest::long_t >( status, names.receptor_ ) : 0;
+                    record.deliver_interval_ = status->known( names.deliver_interval_ ) 
+                        ? getValue< nest::long_t >( status, names.deliver_interval_ ) : -1;
+                    record.delay_ = getValue< nest::double_t >( status, names.delay_ );
+                    record.weight_baseline_ = get_or_nan( status, names.weight_baseline_ );
+                    record.alpha_ = get_or_nan( status, names.alpha_ );
+                    record.weight_ = get_or_nan( status, names.weight_ );
+                }
+            }
+            catch ( ... )
+            {
+                errors[ t ] = std::current_exception();
+            }
+        }
+        for ( nest::thread t = 0; t < num_threads; ++t )
+            if ( errors[ t ] )
+                std::rethrow_exception( errors[ t ] );
+
+        std::ofstream out( rank_filename( filename ).c_str(), std::ios::binary );
+        if ( not out )
+            throw nest::BadProperty( "Could not open " + rank_filename( filename ) + " for writing." );
+
+        // header, model table, size of the section of each thread, sections
+        out.write( checkpoint_magic, sizeof( checkpoint_magic ) );
+        write_value< nest::long_t >( out, models.size() );
+        for ( size_t m = 0; m < models.size(); ++m )
+        {
+            write_string( out, models[ m ].name_ );
+            write_dictionary( out, models[ m ].defaults_ );
+        }
+
+        nest::long_t num_synapses = 0;
+        write_value< nest::long_t >( out, num_threads );
+        for ( nest::thread t = 0; t < num_threads; ++t )
+        {
+            write_value< nest::long_t >( out, records[ t ].size() );
+            num_synapses += records[ t ].size();
+        }
+        for ( nest::thread t = 0; t < num_threads; ++t )
+            out.write( reinterpret_cast< const char* >( records[ t ].data() ), 
+                    records[ t ].size()*sizeof( CheckpointRecord ) );
+
+        if ( not out )
+            throw nest::BadProperty( "Could not write " + rank_filename( filename ) + "." );
+
+        return num_synapses;
+    }
+
+    nest::long_t load_modulatory_synapses( const std::string& filename )
+    {
+        nest::Network& net = nest::NestModule::get_network();
+        const std::string name = rank_filename( filename );
+
+        const int fd = open( name.c_str(), O_RDONLY );
+        if ( fd < 0 )
+            throw nest::BadProperty( "Could not open " + name + " for reading." );
+        
+        struct stat file_stat;
+        if ( fstat( fd, &file_stat ) != 0 or file_stat.st_size == 0 )
+        {
+            close( fd );
+            throw nest::BadProperty( "Could not read " + name + "." );
+        }
+
+        void* map = mmap( 0, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+        close( fd );
+        if ( map == MAP_FAILED )
+            throw nest::BadProperty( "Could not map " + name + " in memory." );
+
+        const char* begin = static_cast< const char* >( map );
+        const char* end = begin + file_stat.st_size;
+        const char* p = begin;
+
+        std::vector< nest::index > syn_ids;
+        std::vector< nest::long_t > section_sizes;
+        try
+        {
+            if ( file_stat.st_size < static_cast< off_t >( sizeof( checkpoint_magic ) ) 
+                    or std::memcmp( p, checkpoint_magic, sizeof( checkpoint_magic ) ) != 0 )
+                throw nest::BadProperty( name + " is not a modulatory checkpoint file." );
+            p += sizeof( checkpoint_magic );
+
+            // models must exist already, their common properties are restored
+            const nest::long_t num_models = read_value< nest::long_t >( p, end );
+            for ( nest::long_t m = 0; m < num_models; ++m )
+            {
+                const std::string model_name = read_string( p, end );
+                DictionaryDatum defaults = read_dictionary( p, end );
+
+                const Token synmodel = net.get_synapsedict().lookup( model_name );
+                if ( synmodel.empty() )
+                    throw nest::UnknownSynapseType( model_name );
+                syn_ids.push_back( static_cast< nest::long_t >( synmodel ) );
+
+                // a model that was never bound has no vt to restore
+                if ( defaults->known( "vt" ) and getValue< nest::long_t >( defaults, "vt" ) < 0 )
+                    defaults->remove( "vt" );
+                net.set_synapse_defaults( syn_ids.back(), defaults );
+            }
+
+            const nest::long_t num_sections = read_value< nest::long_t >( p, end );
+            for ( nest::long_t s = 0; s < num_sections; ++s )
+                section_sizes.push_back( read_value< nest::long_t >( p, end ) );
+        }
+        catch ( ... )
+        {
+            munmap( map, file_stat.st_size );
+            throw;
+        }
+
+        std::vector< const char* > sections;
+        for ( size_t s = 0; s < section_sizes.size(); ++s )
+        {
+            sections.push_back( p );
+            p += section_sizes[ s ]*sizeof( CheckpointRecord );
+        }
+        if ( p > end )
+        {
+            munmap( map, file_stat.st_size );
+            throw nest::BadProperty( "Truncated modulatory checkpoint file." );
+        }
+
+        // Network::connect is not thread safe in NEST 2.10, the synapses are
+        // created one by one, each on the thread of its target
+        const CheckpointNames names;
+        nest::long_t total = 0;
+        try
+        {
+            DictionaryDatum params( new Dictionary );
+            for ( size_t s = 0; s < sections.size(); ++s )
+                for ( nest::long_t i = 0; i < section_sizes[ s ]; ++i )
+                {
+                    CheckpointRecord record;
+                    std::memcpy( &record, sections[ s ] + i*sizeof( CheckpointRecord ), 
+                            sizeof( CheckpointRecord ) );
+
+                    if ( not net.is_local_gid( record.target_ ) )
+                        continue;
+                    nest::Node* target = net.get_node( record.target_ );
+
+                    params->clear();
+                    def< nest::long_t >( params, names.receptor_type_, record.receptor_ );
+                    if ( record.deliver_interval_ >= 0 )
+                        def< nest::long_t >( params, names.deliver_interval_, record.deliver_interval_ );
+                    if ( record.weight_baseline_ == record.weight_baseline_ )
+                        def< nest::double_t >( params, names.weight_baseline_, record.weight_baseline_ );
+                    if ( record.alpha_ == record.alpha_ )
+                        def< nest::double_t >( params, names.alpha_, record.alpha_ );
+
+                    // a NaN weight leaves the default of the model
+                    net.connect( record.source_, target, target->get_thread(), 
+                            syn_ids.at( record.model_ ), params, record.delay_, record.weight_ );
+                    ++total;
+                }
+        }
+        catch ( ... )
+        {
+            munmap( map, file_stat.st_size );
+            throw;
+        }
+        munmap( map, file_stat.st_size );
+
+        return total;
+    }
+
+} // of namespace nest
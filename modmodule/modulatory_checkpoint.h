@@ -0,0 +1,70 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+/*
+ *  Binary checkpoint of the modulatory synapses.
+ *
+ *  save_modulatory_synapses() writes the local synapses of all the models 
+ *  whose common properties are ModulatoryCommonProperties (the models of this
+ *  module and their copies) to a binary file: one section per thread holding,
+ *  for each synapse, source, target, model, receptor, delay, weight_baseline, 
+ *  alpha, deliver_interval and current weight, preceded by the defaults of
+ *  each model (vt gid, max_modulation, the response function, the laws and
+ *  the parameters of the "_hom" models, ...) as typed key/value entries.
+ *  The synapses of the STDP models are refused, their traces are not saved.
+ *
+ *  load_modulatory_synapses() maps the file in memory, restores the defaults
+ *  and recreates the synapses one by one, Network::connect not being thread
+ *  safe. The neurons, the volume transmitters and the copied models must have
+ *  been created again with the same gids and names before loading.
+ *
+ *  With MPI each rank writes and reads its own file, <filename>.<rank>.
+ */
+
+#ifndef MODULATORY_CHECKPOINT_H
+#define MODULATORY_CHECKPOINT_H
+
+#include "nest_types.h"
+#include <string>
+
+namespace mynest
+{
+
+    /**
+     * Write all the local modulatory synapses to filename.
+     * @return the number of synapses written
+     */
+    nest::long_t save_modulatory_synapses( const std::string& filename );
+
+    /**
+     * Recreate the modulatory synapses stored in filename.
+     * @return the number of synapses created
+     */
+    nest::long_t load_modulatory_synapses( const std::string& filename );
+
+} // namespace mynest
+
+#endif // MODULATORY_CHECKPOINT_H
@@ -29,19 +29,158 @@
 #include "connector_model.h"
 #include "common_synapse_properties.h"
 #include "modulatory_connection.h"
+#include "modulation_recorder.h"
 #include "event.h"
 #include "nestmodule.h"
 
+#include <algorithm>
+#include <cmath>
+#include <map>
+
 namespace mynest
 {
+    //
+    // Implementation of class ResponseFunction.
+    //
+
+    void ResponseFunction::tabulate()
+    {
+        if ( table_size_ < 2 )
+            throw nest::BadProperty( "table_size must be at least 2." );
+
+        if ( modulation_function_ == "linear" )
+        {
+            table_.clear();
+        }
+        else if ( modulation_function_ == "table" )
+        {
+            const size_t n = table_modulation_.size();
+            if ( n < 2 or table_values_.size() != n )
+                throw nest::BadProperty( "table_modulation and table_values must "
+                        "have the same size, at least 2." );
+            for ( size_t i = 1; i < n; ++i )
+                if ( table_modulation_[ i ] <= table_modulation_[ i - 1 ] )
+                    throw nest::BadProperty( "table_modulation must be strictly increasing." );
+
+            table_min_ = table_modulation_.front();
+            table_scale_ = ( table_size_ - 1 )/( table_modulation_.back() - table_min_ );
+            table_.resize( table_size_ );
+
+            // resample the piecewise linear function on a regular grid
+            size_t k = 0;
+            for ( size_t i = 0; i < table_.size(); ++i )
+            {
+                const nest::double_t m = table_min_ + i/table_scale_;
+                while ( k < n - 2 and m > table_modulation_[ k + 1 ] )
+                    ++k;
+                const nest::double_t f = ( m - table_modulation_[ k ] )
+                    /( table_modulation_[ k + 1 ] - table_modulation_[ k ] );
+                table_[ i ] = table_values_[ k ] + f*( table_values_[ k + 1 ] - table_values_[ k ] );
+            }
+        }
+        else if ( modulation_function_ == "sigmoid" )
+        {
+            if ( table_max_ <= 0 )
+                throw nest::BadProperty( "table_max must be positive." );
+
+            table_min_ = 0.0;
+            table_scale_ = ( table_size_ - 1 )/table_max_;
+            table_.resize( table_size_ );
+
+            for ( size_t i = 0; i < table_.size(); ++i )
+            {
+                const nest::double_t m = i/table_scale_;
+                table_[ i ] = sigmoid_min_ + ( sigmoid_max_ - sigmoid_min_ )
+                    /( 1.0 + std::exp( -sigmoid_slope_*( m - sigmoid_threshold_ ) ) );
+            }
+        }
+        else
+            throw nest::BadProperty( "modulation_function must be one of "
+                    "\"linear\", \"table\" or \"sigmoid\"." );
+    }
+
+    //
+    // Implementation of class ModulationCache.
+    //
+
+    ModulationCache* ModulationCache::get_cache( nest::long_t vt_gid )
+    {
+        // one cache per volume transmitter, map nodes never move
+        static std::map< nest::long_t, ModulationCache > caches;
+        return &caches[ vt_gid ];
+    }
+
+    void ModulationCache::reset( nest::thread num_threads )
+    {
+        entries_.assign( num_threads, ModulationCacheEntry() );
+        recorded_.clear();
+    }
+
+    void ModulationCache::add_recorder( modulation_recorder* recorder )
+    {
+        if ( std::find( recorders_.begin(), recorders_.end(), recorder ) == recorders_.end() )
+            recorders_.push_back( recorder );
+    }
+
+    void ModulationCache::remove_recorder( modulation_recorder* recorder )
+    {
+        recorders_.erase( std::remove( recorders_.begin(), recorders_.end(), recorder ), 
+                recorders_.end() );
+    }
+
+    void ModulationCache::record( nest::synindex syn_id,
+            nest::double_t t_trig,
+            nest::double_t num_spikes,
+            nest::double_t modulation,
+            nest::double_t response )
+    {
+        // entered once per thread, model and trigger, and only while recording 
+#pragma omp critical( modulation_recorder )
+        {
+            // keyed by syn_id, as copied models keep the common properties 
+            // of the original until their defaults are set
+            std::map< nest::synindex, nest::double_t >::iterator last = recorded_.find( syn_id );
+            if ( last == recorded_.end() or last->second != t_trig )
+            {
+                recorded_[ syn_id ] = t_trig;
+                const std::string model = 
+                    nest::NestModule::get_network().get_synapse_prototype( syn_id ).get_name();
+                for ( auto recorder: recorders_ )
+                    recorder->record( t_trig, model, num_spikes, modulation, response );
+            }
+        }
+    }
+
+    //
+    // Implementation of class ModulationCounters.
+    //
+
+    ModulationCountersVector* ModulationCounters::get_counters( const std::string& model )
+    {
+        // one set of counters per model name, map nodes never move
+        static std::map< std::string, ModulationCountersVector > counters;
+        return &counters[ model ];
+    }
+
     //
     // Implementation of class ModulatoryCommonProperties.
     //
 
+    bool ModulatoryCommonProperties::defer_invalidation_ = false;
+
     ModulatoryCommonProperties::ModulatoryCommonProperties()
         : nest::CommonSynapseProperties(),
         vt_( 0 ),
-        max_modulation_(1.0)
+        signal_( 0 ),
+        normalised_signal_( false ),
+        cache_( 0 ),
+        max_modulation_(1.0),
+        lazy_weight_(false),
+        tau_modulation_(0.0),
+        modulation_delay_(0),
+        clamp_weight_(false),
+        silence_threshold_(-1.0),
+        function_()
     {
     }
 
@@ -49,42 +188,207 @@ namespace mynest
     {
         nest::CommonSynapseProperties::get_status( d );
 
-        if ( vt_ != 0 )
-            def< nest::long_t >( d, "vt", vt_->get_gid() );
-        else
-            def< nest::long_t >( d, "vt", -1 );
+        def< nest::long_t >( d, "vt", get_vt_gid() );
         
         def< nest::long_t >( d, "max_modulation", max_modulation_ );
+        def< bool >( d, "lazy_weight", lazy_weight_ );
+        def< nest::double_t >( d, "tau_modulation", tau_modulation_ );
+        def< nest::long_t >( d, "modulation_delay", modulation_delay_ );
+        def< bool >( d, "clamp_weight", clamp_weight_ );
+        def< nest::double_t >( d, "silence_threshold", silence_threshold_ );
+        def< std::string >( d, "modulation_function", function_.modulation_function_ );
+        def< std::vector< nest::double_t > >( d, "table_modulation", function_.table_modulation_ );
+        def< std::vector< nest::double_t > >( d, "table_values", function_.table_values_ );
+        def< nest::double_t >( d, "sigmoid_min", function_.sigmoid_min_ );
+        def< nest::double_t >( d, "sigmoid_max", function_.sigmoid_max_ );
+        def< nest::double_t >( d, "sigmoid_slope", function_.sigmoid_slope_ );
+        def< nest::double_t >( d, "sigmoid_threshold", function_.sigmoid_threshold_ );
+        def< nest::double_t >( d, "table_max", function_.table_max_ );
+        def< nest::long_t >( d, "table_size", function_.table_size_ );
+
+        def< bool >( d, "instrument", counters_ != 0 );
+        if ( counters_ != 0 )
+        {
+            // a trigger is seen by every thread, synapses and spikes are split among them
+            ModulationCounters total;
+            nest::long_t triggers = 0;
+            for ( auto & c: *counters_ )
+            {
+                // the sweep of the last trigger is only closed by the next one
+                c.end_trigger();
+
+                triggers = std::max( triggers, c.triggers_ );
+                total.triggers_ += c.triggers_;
+                total.synapses_ += c.synapses_;
+                total.updates_ += c.updates_;
+                total.spikes_ += c.spikes_;
+                total.trigger_time_ += c.trigger_time_;
+                total.max_trigger_time_ = std::max( total.max_trigger_time_, c.max_trigger_time_ );
+                total.modulation_sum_ += c.modulation_sum_;
+                total.modulation_min_ = std::min( total.modulation_min_, c.modulation_min_ );
+                total.modulation_max_ = std::max( total.modulation_max_, c.modulation_max_ );
+            }
+
+            def< nest::long_t >( d, "num_triggers", triggers );
+            def< nest::double_t >( d, "synapses_per_trigger", 
+                    triggers > 0 ? static_cast< nest::double_t >( total.synapses_ )/triggers : 0.0 );
+            def< nest::double_t >( d, "updates_per_trigger", 
+                    triggers > 0 ? static_cast< nest::double_t >( total.updates_ )/triggers : 0.0 );
+            def< nest::double_t >( d, "trigger_time", total.trigger_time_ );
+            def< nest::double_t >( d, "max_trigger_time", total.max_trigger_time_ );
+            def< nest::long_t >( d, "num_spikes_sent", total.spikes_ );
+            if ( total.triggers_ > 0 )
+            {
+                def< nest::double_t >( d, "modulation_min", total.modulation_min_ );
+                def< nest::double_t >( d, "modulation_mean", total.modulation_sum_/total.triggers_ );
+                def< nest::double_t >( d, "modulation_max", total.modulation_max_ );
+            }
+        }
 
     }
 
     void ModulatoryCommonProperties::set_status( const DictionaryDatum& d, 
             nest::ConnectorModel& cm )
     {
-        nest::CommonSynapseProperties::set_status( d, cm );
-       
-        updateValue< nest::long_t >( d, "max_modulation", max_modulation_ );
+        // every key is parsed and checked before anything is changed, 
+        // so that an invalid dictionary leaves the model untouched
+        ResponseFunction function = function_;
+
+        bool function_changed = false;
+        function_changed |= updateValue< std::string >( d, "modulation_function", function.modulation_function_ );
+        function_changed |= updateValue< std::vector< nest::double_t > >( d, "table_modulation", function.table_modulation_ );
+        function_changed |= updateValue< std::vector< nest::double_t > >( d, "table_values", function.table_values_ );
+        function_changed |= updateValue< nest::double_t >( d, "sigmoid_min", function.sigmoid_min_ );
+        function_changed |= updateValue< nest::double_t >( d, "sigmoid_max", function.sigmoid_max_ );
+        function_changed |= updateValue< nest::double_t >( d, "sigmoid_slope", function.sigmoid_slope_ );
+        function_changed |= updateValue< nest::double_t >( d, "sigmoid_threshold", function.sigmoid_threshold_ );
+        function_changed |= updateValue< nest::double_t >( d, "table_max", function.table_max_ );
+        function_changed |= updateValue< nest::long_t >( d, "table_size", function.table_size_ );
+        if ( function_changed )
+            function.tabulate();
+
+        nest::long_t max_modulation = max_modulation_;
+        if ( updateValue< nest::long_t >( d, "max_modulation", max_modulation ) 
+                and max_modulation < 1 )
+            throw nest::BadProperty( "max_modulation must be positive." );
+
+        nest::double_t tau = tau_modulation_;
+        if ( updateValue< nest::double_t >( d, "tau_modulation", tau ) and tau < 0 )
+            throw nest::BadProperty( "tau_modulation must be non-negative." );
+
+        nest::long_t modulation_delay = modulation_delay_;
+        const bool delay_changed = 
+            updateValue< nest::long_t >( d, "modulation_delay", modulation_delay );
+        if ( modulation_delay < 0 )
+            throw nest::BadProperty( "modulation_delay must be non-negative." );
+
+        bool lazy_weight = lazy_weight_;
+        updateValue< bool >( d, "lazy_weight", lazy_weight );
+        bool clamp_weight = clamp_weight_;
+        updateValue< bool >( d, "clamp_weight", clamp_weight );
+        nest::double_t silence_threshold = silence_threshold_;
+        updateValue< nest::double_t >( d, "silence_threshold", silence_threshold );
+        bool instrument = counters_ != 0;
+        const bool instrument_changed = updateValue< bool >( d, "instrument", instrument );
 
         nest::long_t vtgid;
-        if ( updateValue< nest::long_t >( d, "vt", vtgid ) )
+        const bool vt_changed = updateValue< nest::long_t >( d, "vt", vtgid );
+        nest::volume_transmitter* vt = vt_;
+        ModulationSignal* signal = signal_;
+        if ( vt_changed )
+        {
+            nest::Node* source = nest::NestModule::get_network().get_node( vtgid );
+            vt = dynamic_cast< nest::volume_transmitter* >( source );
+            signal = dynamic_cast< ModulationSignal* >( source );
+
+            if ( vt == 0 and signal == 0 )
+                throw nest::BadProperty( "Modulatory source must be volume "
+                        "transmitter, modulation_replay, modulation_rate or modulation_reducer" );
+        }
+
+        // all checked, commit
+        nest::CommonSynapseProperties::set_status( d, cm );
+
+        max_modulation_ = max_modulation;
+        lazy_weight_ = lazy_weight;
+        tau_modulation_ = tau;
+        clamp_weight_ = clamp_weight;
+        silence_threshold_ = silence_threshold;
+
+        // a new delay starts from an empty line
+        if ( delay_changed )
         {
-            vt_ = dynamic_cast< nest::volume_transmitter* >( 
-                    nest::NestModule::get_network().get_node( vtgid ) );
+            modulation_delay_ = modulation_delay;
+            for ( auto & line: delay_lines_ )
+                line.clear();
+        }
+
+        // the response function is tabulated again only if it changed
+        if ( function_changed )
+            std::swap( function_, function );
+
+        // switching the counters on starts them from zero 
+        if ( instrument_changed )
+        {
+            if ( instrument )
+            {
+                counters_ = ModulationCounters::get_counters( cm.get_name() );
+                counters_->assign( nest::NestModule::get_network().get_num_threads(), 
+                        ModulationCounters() );
+            }
+            else
+                counters_ = 0;
+        }
+
+        if ( vt_changed )
+        {
+            vt_ = vt;
+            signal_ = signal;
+            normalised_signal_ = signal != 0 and signal->is_normalised();
+
+            // (re)binding a model to a volume transmitter discards the 
+            // sums cached for a previous one with the same gid
+            const nest::thread num_threads = 
+                nest::NestModule::get_network().get_num_threads();
+            cache_ = ModulationCache::get_cache( vtgid );
+            cache_->reset( num_threads );
 
-            if ( vt_ == 0 )
-                throw nest::BadProperty( "Modulatory source must be "
-                        "volume transmitter" );
+            // the synapses keep the epoch of their last weight, so the 
+            // fresh states start past it instead of at 0
+            std::vector< ModulationState, CacheLineAllocator< ModulationState > > state( num_threads );
+            for ( size_t t = 0; t < state.size() and t < state_.size(); ++t )
+                state[ t ].epoch_ = state_[ t ].epoch_ + 1;
+            state_.swap( state );
+            delay_lines_.assign( num_threads, std::vector< nest::double_t >() );
         }
 
+        invalidate();
+
+    }
+
+    void ModulatoryCommonProperties::record( nest::thread t,
+            nest::synindex syn_id,
+            const std::vector< nest::spikecounter >& modulatory_spikes,
+            nest::double_t t_trig,
+            nest::double_t response ) const
+    {
+        ModulationState& state = state_[ t ];
+        state.record_ = false;
+
+        // with an exponential trace the spikes have not been summed
+        const nest::double_t num_spikes = cache_->get_num_spikes( t, modulatory_spikes, t_trig );
+        cache_->record( syn_id, t_trig, num_spikes, state.modulation_, response );
     }
 
     nest::Node* ModulatoryCommonProperties::get_node()
     {
-        if ( vt_ == 0 )
+        if ( vt_ != 0 )
+            return vt_;
+        else if ( signal_ != 0 )
+            return signal_;
+        else
             throw nest::BadProperty( "No volume transmitter has "
                     "been assigned to the dopamine synapse." );
-        else
-            return vt_;
     }
 
 } // of namespace nest
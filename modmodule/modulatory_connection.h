@@ -33,7 +33,9 @@
  *  The class ModulatoryConnection implements a generic synapse in which   
  *  the information from the volume transmitter modulates the amplitude of the weight.
  *  In particular the *modulation* ( ratio of spikes per delivery interval of the 
- *  volume transmitter) directly multiplies the baseline weight.
+ *  volume transmitter) is passed to a modulation law which multiplies the 
+ *  baseline weight. The law is a policy class given as template argument,  
+ *  by default the *modulation* directly multiplies the baseline weight.
  *
  *  Parameters:
  *      initial_weight =>  the baseline value which has to be multiplied times the *modulation* 
@@ -45,10 +47,380 @@
 
 #include "connection.h"
 #include "static_connection.h"
+#include "modulation_signal.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <new>
+#include <string>
 #include <vector>
 
 namespace mynest
 {
+    class modulation_recorder;
+
+    //! Size of a cache line, the alignment of the per-thread entries below
+    const size_t CACHE_LINE_SIZE = 64;
+
+    /**
+     * Allocator returning memory aligned to a cache line, for the vectors
+     * of per-thread entries: the default allocator only guarantees the
+     * alignment of the fundamental types, so that adjacent entries could 
+     * still share a line.
+     */
+    template < typename T >
+        struct CacheLineAllocator
+        {
+            typedef T value_type;
+
+            CacheLineAllocator()
+            {
+            }
+
+            template < typename U >
+                CacheLineAllocator( const CacheLineAllocator< U >& )
+                {
+                }
+
+            T* allocate( size_t n )
+            {
+                void* p = 0;
+                if ( posix_memalign( &p, CACHE_LINE_SIZE, n*sizeof( T ) ) != 0 )
+                    throw std::bad_alloc();
+                return static_cast< T* >( p );
+            }
+
+            void deallocate( T* p, size_t )
+            {
+                std::free( p );
+            }
+        };
+
+    template < typename T, typename U >
+        bool operator==( const CacheLineAllocator< T >&, const CacheLineAllocator< U >& )
+        {
+            return true;
+        }
+
+    template < typename T, typename U >
+        bool operator!=( const CacheLineAllocator< T >&, const CacheLineAllocator< U >& )
+        {
+            return false;
+        }
+
+    /**
+     * Sum of the modulatory spikes delivered by a volume transmitter
+     * at its last trigger, as seen by one thread.
+     * Aligned to a cache line so that threads never share one.
+     */
+    struct alignas( CACHE_LINE_SIZE ) ModulationCacheEntry
+    {
+        ModulationCacheEntry()
+            : t_trig_(-1.0)
+              ,num_spikes_(0.0)
+        {
+        }
+
+        nest::double_t t_trig_; //!< time of the trigger the sum refers to
+        nest::double_t num_spikes_; //!< sum of the multiplicities of the modulatory spikes
+    };
+
+    /**
+     * Per-thread cache of the modulatory spike sums of one volume transmitter.
+     * There is a single cache for each volume transmitter, shared by all
+     * the synapse models (and their copies) bound to it, so that the 
+     * spikes are summed only once per thread and trigger.
+     */
+    class ModulationCache
+    {
+        public:
+
+            /**
+             * Return the cache of the volume transmitter with the given gid,
+             * creating it if needed.
+             */
+            static ModulationCache* get_cache( nest::long_t vt_gid );
+
+            /**
+             * Forget all cached sums and make room for the given number of threads.
+             */
+            void reset( nest::thread num_threads );
+
+            /**
+             * Sum of the multiplicities of the modulatory spikes delivered at t_trig.
+             * The spikes are summed only by the first synapse triggered on thread t.
+             */
+            nest::double_t get_num_spikes( nest::thread t,
+                    const std::vector< nest::spikecounter >& modulatory_spikes,
+                    nest::double_t t_trig );
+
+            //! Publish the samples of this volume transmitter to a modulation_recorder
+            void add_recorder( modulation_recorder* recorder );
+
+            void remove_recorder( modulation_recorder* recorder );
+
+            //! True if some modulation_recorder records this volume transmitter
+            bool is_recorded() const
+            {
+                return not recorders_.empty();
+            }
+
+            /**
+             * Pass the sample of the model syn_id at t_trig to the recorders.
+             * Each model is recorded once per trigger, by the first thread
+             * that publishes it.
+             */
+            void record( nest::synindex syn_id,
+                    nest::double_t t_trig,
+                    nest::double_t num_spikes,
+                    nest::double_t modulation,
+                    nest::double_t response );
+
+        private:
+
+            std::vector< ModulationCacheEntry, CacheLineAllocator< ModulationCacheEntry > > entries_;
+
+            std::vector< modulation_recorder* > recorders_;
+
+            //! time of the last sample recorded for each model
+            std::map< nest::synindex, nest::double_t > recorded_;
+    };
+
+    inline nest::double_t ModulationCache::get_num_spikes( nest::thread t,
+            const std::vector< nest::spikecounter >& modulatory_spikes,
+            nest::double_t t_trig )
+    {
+        // threads added after the last reset do not cache 
+        if ( static_cast< size_t >( t ) >= entries_.size() )
+        {
+            nest::double_t num_spikes = 0;
+            for(const auto & sc: modulatory_spikes)
+                num_spikes += sc.multiplicity_;
+            return num_spikes;
+        }
+
+        ModulationCacheEntry& entry = entries_[ t ];
+        if ( entry.t_trig_ != t_trig )
+        {
+            entry.num_spikes_ = 0;
+            for(const auto & sc: modulatory_spikes)
+                entry.num_spikes_ += sc.multiplicity_;
+            entry.t_trig_ = t_trig;
+        }
+
+        return entry.num_spikes_;
+    }
+
+    /**
+     * Modulation computed for the synapses of one model on one thread 
+     * at the last trigger.
+     * Aligned to a cache line so that threads never share one.
+     */
+    struct alignas( CACHE_LINE_SIZE ) ModulationState
+    {
+        ModulationState()
+            : t_trig_(-1.0)
+              ,modulation_(0.0)
+              ,num_spikes_(0.0)
+              ,trace_(0.0)
+              ,delayed_(0.0)
+              ,deliver_interval_(0)
+              ,epoch_(0)
+              ,delay_head_(0)
+              ,changed_(true)
+              ,dirty_(true)
+              ,record_(false)
+        {
+        }
+
+        nest::double_t t_trig_; //!< time of the trigger the modulation refers to
+        nest::double_t modulation_; //!< normalised modulation
+        nest::double_t num_spikes_; //!< sum of the modulatory spikes at t_trig_
+        nest::double_t trace_; //!< exponential trace of the modulatory spikes at t_trig_
+        nest::double_t delayed_; //!< spike sum or trace of modulation_delay triggers ago
+        nest::long_t deliver_interval_; //!< deliver interval used to normalise
+        unsigned int epoch_; //!< incremented each time the synapses need a new weight
+        unsigned int delay_head_; //!< oldest value of the delay line of the thread
+        bool changed_; //!< modulation differs from the one at the previous trigger
+        bool dirty_; //!< synapses have been created or changed since the last trigger
+        bool record_; //!< the sample of this trigger has not been recorded yet
+    };
+
+    /**
+     * Instrumentation counters of the synapses of one model on one thread,
+     * collected only when the instrument property of the model is set.
+     * Aligned to a cache line so that threads never share one.
+     */
+    struct ModulationCounters;
+
+    //! Per-thread counters of one model
+    typedef std::vector< ModulationCounters, CacheLineAllocator< ModulationCounters > > 
+        ModulationCountersVector;
+
+    struct alignas( CACHE_LINE_SIZE ) ModulationCounters
+    {
+        ModulationCounters()
+            : triggers_(0)
+              ,synapses_(0)
+              ,updates_(0)
+              ,spikes_(0)
+              ,trigger_time_(0.0)
+              ,max_trigger_time_(0.0)
+              ,modulation_sum_(0.0)
+              ,modulation_min_(std::numeric_limits< nest::double_t >::infinity())
+              ,modulation_max_(-std::numeric_limits< nest::double_t >::infinity())
+              ,trigger_start_(0)
+              ,last_update_(0)
+        {
+        }
+
+        /**
+         * Return the counters of the model with the given name, shared by 
+         * the copies of its common properties on all threads.
+         */
+        static ModulationCountersVector* get_counters( const std::string& model );
+
+        //! Nanoseconds of a monotonic clock
+        static std::int64_t now()
+        {
+            return std::chrono::duration_cast< std::chrono::nanoseconds >( 
+                    std::chrono::steady_clock::now().time_since_epoch() ).count();
+        }
+
+        //! Add the sweep of the last trigger, if still open, to the trigger times
+        void end_trigger()
+        {
+            if ( trigger_start_ != 0 )
+            {
+                const nest::double_t span = 1e-6*( last_update_ - trigger_start_ );
+                trigger_time_ += span;
+                max_trigger_time_ = std::max( max_trigger_time_, span );
+                trigger_start_ = 0;
+            }
+        }
+
+        //! Close the sweep of the previous trigger and open a new one 
+        void begin_trigger( nest::double_t modulation )
+        {
+            end_trigger();
+            trigger_start_ = last_update_ = now();
+            ++triggers_;
+            modulation_sum_ += modulation;
+            modulation_min_ = std::min( modulation_min_, modulation );
+            modulation_max_ = std::max( modulation_max_, modulation );
+        }
+
+        //! Count synapses triggered, of which updated had their weight recomputed
+        void count_synapses( size_t n, size_t updated )
+        {
+            synapses_ += n;
+            updates_ += updated;
+            last_update_ = now();
+        }
+
+        nest::long_t triggers_; //!< triggers seen by the thread
+        nest::long_t synapses_; //!< synapses triggered
+        nest::long_t updates_; //!< synapses whose weight was recomputed
+        nest::long_t spikes_; //!< spikes sent
+        nest::double_t trigger_time_; //!< ms spent in the closed trigger sweeps
+        nest::double_t max_trigger_time_; //!< ms of the longest trigger sweep
+        nest::double_t modulation_sum_; //!< sum of the modulation over the triggers
+        nest::double_t modulation_min_;
+        nest::double_t modulation_max_;
+        std::int64_t trigger_start_; //!< ns at the first synapse of the current trigger, 0 once closed
+        std::int64_t last_update_; //!< ns at the last synapse of the current trigger
+    };
+
+    /**
+     * Pointer to the counters of a model. Copies of the common properties,
+     * as those made by CopyModel, start uninstrumented, so that a copied
+     * model never adds to the counters of the original.
+     */
+    class ModulationCountersPtr
+    {
+        public:
+            ModulationCountersPtr()
+                : counters_( 0 )
+            {
+            }
+
+            ModulationCountersPtr( const ModulationCountersPtr& )
+                : counters_( 0 )
+            {
+            }
+
+            ModulationCountersPtr& operator=( const ModulationCountersPtr& )
+            {
+                counters_ = 0;
+                return *this;
+            }
+
+            ModulationCountersPtr& operator=( ModulationCountersVector* counters )
+            {
+                counters_ = counters;
+                return *this;
+            }
+
+            operator ModulationCountersVector*() const
+            {
+                return counters_;
+            }
+
+            ModulationCountersVector* operator->() const
+            {
+                return counters_;
+            }
+
+        private:
+            ModulationCountersVector* counters_;
+    };
+
+    /**
+     * Dose-response function applied to the normalised modulation before 
+     * the modulation law, together with its precomputed table.
+     */
+    struct ResponseFunction
+    {
+        ResponseFunction()
+            : modulation_function_("linear")
+              ,sigmoid_min_(0.0)
+              ,sigmoid_max_(1.0)
+              ,sigmoid_slope_(10.0)
+              ,sigmoid_threshold_(0.5)
+              ,table_max_(1.0)
+              ,table_size_(1000)
+              ,table_min_(0.0)
+              ,table_scale_(0.0)
+        {
+        }
+
+        //! Precompute the table of the function, throw if it is not valid
+        void tabulate();
+
+        /**
+         * "linear" (none), "table" (piecewise linear through 
+         * table_modulation/table_values) or "sigmoid".
+         */
+        std::string modulation_function_;
+
+        std::vector< nest::double_t > table_modulation_; //!< abscissae of the piecewise linear function
+        std::vector< nest::double_t > table_values_; //!< ordinates of the piecewise linear function
+
+        nest::double_t sigmoid_min_; //!< value of the sigmoid at -inf
+        nest::double_t sigmoid_max_; //!< value of the sigmoid at +inf
+        nest::double_t sigmoid_slope_; //!< slope of the sigmoid
+        nest::double_t sigmoid_threshold_; //!< modulation at half height of the sigmoid
+        nest::double_t table_max_; //!< the sigmoid is tabulated over [0, table_max] 
+        nest::long_t table_size_; //!< number of samples in the table
+
+        std::vector< nest::double_t > table_; //!< tabulated function, empty if linear
+        nest::double_t table_min_; //!< modulation of the first sample
+        nest::double_t table_scale_; //!< samples per unit of modulation
+    };
 
     /**
      * Class containing the common properties for all synapses of type dopamine connection.
@@ -76,36 +448,436 @@ namespace mynest
 
             nest::long_t get_vt_gid() const;
 
+            /**
+             * Return the modulation at trigger time t_trig on thread t, normalised
+             * over the given deliver interval.
+             * It is computed only by the first synapse triggered on the thread,
+             * all the other synapses read the cached value. 
+             * @param changed set to false if the synapses do not need to update 
+             *        their weight because neither the modulation nor the synapses 
+             *        changed since the previous trigger 
+             */
+            nest::double_t get_modulation( nest::thread t,
+                    const std::vector< nest::spikecounter >& modulatory_spikes,
+                    nest::double_t t_trig,
+                    nest::long_t deliver_interval,
+                    bool& changed ) const;
+
+            /**
+             * Force all the synapses to update their weight at the next trigger.
+             * To be called whenever a synapse is created or its parameters change.
+             * Does nothing while invalidation is deferred.
+             */
+            void invalidate() const;
+
+            /**
+             * While set, invalidate() does nothing. Set by the bulk parameter
+             * functions around the parallel regions in which the threads 
+             * change their synapses, which then invalidate the models once.
+             */
+            static bool defer_invalidation_;
+
+            /**
+             * Used by the synapses when lazy_weight is set, to compute their 
+             * weight only when they send a spike.
+             * Return true if the weight of a synapse stamped with the given epoch
+             * is stale on thread t. In that case the epoch is updated and 
+             * modulation is set to the current modulation normalised over
+             * the given deliver interval.
+             */
+            bool get_lazy_modulation( nest::thread t,
+                    unsigned int& epoch,
+                    nest::long_t deliver_interval,
+                    nest::double_t& modulation ) const;
+
+            //! Modulation of thread t at its last trigger, 0 before the first one
+            nest::double_t get_last_modulation( nest::thread t ) const
+            {
+                if ( static_cast< size_t >( t ) >= state_.size() or state_[ t ].t_trig_ < 0 )
+                    return 0.0;
+                return state_[ t ].modulation_;
+            }
+
+            //! The modulated weight, stopped at 0 if clamp_weight is set and it changed sign
+            nest::double_t clamp( nest::double_t weight, nest::double_t weight_baseline ) const
+            {
+                return ( clamp_weight_ and weight*weight_baseline < 0 ) ? 0.0 : weight;
+            }
+
+            //! True if a synapse with the given weight must not deliver its spikes
+            bool is_silenced( nest::double_t weight ) const
+            {
+                return std::abs( weight ) <= silence_threshold_;
+            }
+
+            /**
+             * True if the modulation of thread t at the last trigger 
+             * has to be published to a modulation_recorder.
+             */
+            bool is_recording( nest::thread t ) const
+            {
+                return state_[ t ].record_;
+            }
+
+            /**
+             * Publish the modulation of thread t at t_trig, and the value of the 
+             * modulation law response, to the recorders of the volume transmitter.
+             * The sample is labelled with the model syn_id of the triggered synapse.
+             */
+            void record( nest::thread t,
+                    nest::synindex syn_id,
+                    const std::vector< nest::spikecounter >& modulatory_spikes,
+                    nest::double_t t_trig,
+                    nest::double_t response ) const;
+
+            /**
+             * With instrument set, count n synapses triggered on thread t,
+             * of which updated had their weight recomputed.
+             */
+            void count_synapses( nest::thread t, size_t n, size_t updated ) const
+            {
+                if ( counters_ != 0 and static_cast< size_t >( t ) < counters_->size() )
+                    ( *counters_ )[ t ].count_synapses( n, updated );
+            }
+
+            /**
+             * With instrument set, count the spikes sent on thread t.
+             */
+            void count_spike( nest::thread t ) const
+            {
+                if ( counters_ != 0 and static_cast< size_t >( t ) < counters_->size() )
+                    ++( *counters_ )[ t ].spikes_;
+            }
+
+        private:
+
+            //! True if the modulation is the exponential trace of the spikes
+            bool use_trace() const
+            {
+                return tau_modulation_ > 0 and not normalised_signal_;
+            }
+
+            /**
+             * Normalise the spikes stored in state over the given deliver interval.
+             * With an exponential trace the modulation is the rate of the trace 
+             * and it does not depend on the deliver interval.
+             */
+            nest::double_t normalise( const ModulationState& state, 
+                    nest::long_t deliver_interval ) const;
+
+            /**
+             * Push the spike sum or trace of the current trigger of thread t into
+             * its delay line, and store in state the one of modulation_delay 
+             * triggers ago (0 during the first triggers).
+             */
+            void delay( nest::thread t, ModulationState& state ) const;
+
+            /**
+             * Advance the exponential trace of state from its last trigger to t_trig, 
+             * adding the modulatory spikes with their exact times.
+             */
+            void advance_trace( ModulationState& state, 
+                    const std::vector< nest::spikecounter >& modulatory_spikes,
+                    nest::double_t t_trig ) const;
+
+            /**
+             * Map the normalised modulation through the response function,
+             * interpolating linearly the precomputed table.
+             */
+            nest::double_t response( nest::double_t modulation ) const;
+
+        public:
+
             nest::volume_transmitter* vt_;
 
+            //! modulation given as a value, bound through "vt" in place of vt_
+            ModulationSignal* signal_;
+
+            //! true if signal_ passes the modulation itself rather than spike counts
+            bool normalised_signal_;
+
+            //! spike sums shared with all the models bound to vt_
+            ModulationCache* cache_;
+
+            //! per-thread modulation of this model
+            mutable std::vector< ModulationState, CacheLineAllocator< ModulationState > > state_;
+
 
             /**
              * The max amount of spikes that this transmitter receives
              * (usually the number of neurons in the source population)
              */ 
             nest::long_t max_modulation_;
+
+            /**
+             * If true triggers only update the modulation stored here and 
+             * each synapse recomputes its weight the next time it sends a spike.
+             */
+            bool lazy_weight_;
+
+            /**
+             * Time constant (ms) of the exponential trace of the modulatory spikes.
+             * If 0 the modulation is the count of spikes over the deliver interval,
+             * otherwise it is the rate given by the trace at the trigger time.
+             * Not used with a modulation_replay or modulation_rate; with a 
+             * modulation_reducer all the spikes of an interval are taken at
+             * the trigger time.
+             */
+            nest::double_t tau_modulation_;
+
+            /**
+             * Number of triggers by which the modulation lags the modulatory 
+             * spikes: the synapses are triggered with the modulation 
+             * computed modulation_delay deliver intervals before. 0 disables it.
+             */
+            nest::long_t modulation_delay_;
+
+            /**
+             * Per-thread ring buffers of the last modulation_delay spike sums 
+             * or traces, one per thread as state_.
+             */
+            mutable std::vector< std::vector< nest::double_t > > delay_lines_;
+
+            /**
+             * If true the modulated weight never takes the opposite sign of 
+             * the baseline weight, it stops at 0 (e.g. d2 synapses at high 
+             * modulation).
+             */
+            bool clamp_weight_;
+
+            /**
+             * Synapses whose modulated weight is, in absolute value, not above 
+             * the threshold do not deliver their spikes. Negative disables it.
+             */
+            nest::double_t silence_threshold_;
+
+            //! dose-response function applied to the normalised modulation
+            ResponseFunction function_;
+
+            /**
+             * Per-thread instrumentation counters, null unless instrument 
+             * is set. Timing the trigger sweeps reads the clock once per 
+             * synapse, so the counters slow the triggers down.
+             */
+            ModulationCountersPtr counters_;
     };
 
     inline nest::long_t ModulatoryCommonProperties::get_vt_gid() const
     {
         if ( vt_ != 0 )
             return vt_->get_gid();
+        else if ( signal_ != 0 )
+            return signal_->get_gid();
         else
             return -1;
     }
 
+    inline nest::double_t ModulatoryCommonProperties::get_modulation( nest::thread t,
+            const std::vector< nest::spikecounter >& modulatory_spikes,
+            nest::double_t t_trig,
+            nest::long_t deliver_interval,
+            bool& changed ) const
+    {
+        // presized when the model is bound to its volume transmitter, 
+        // each thread only touches its own entry
+        ModulationState& state = state_[ t ];
+
+        if ( state.t_trig_ != t_trig || state.deliver_interval_ != deliver_interval )
+        {
+            // the trace must be advanced only once per trigger
+            if ( use_trace() and state.t_trig_ != t_trig )
+                advance_trace( state, modulatory_spikes, t_trig );
+            else if ( not use_trace() )
+                state.num_spikes_ = cache_->get_num_spikes( t, modulatory_spikes, t_trig );
+
+            // one step of the delay line per trigger
+            if ( modulation_delay_ > 0 and state.t_trig_ != t_trig )
+                delay( t, state );
+
+            nest::double_t modulation = normalise( state, deliver_interval );
+
+            // synapses with different deliver intervals within the same 
+            // trigger can not rely on the previous value 
+            state.changed_ = state.dirty_ 
+                || state.t_trig_ == t_trig
+                || state.deliver_interval_ != deliver_interval 
+                || state.modulation_ != modulation;
+            
+            if ( state.changed_ )
+                ++state.epoch_;
+
+            if ( counters_ != 0 and state.t_trig_ != t_trig 
+                    and static_cast< size_t >( t ) < counters_->size() )
+                ( *counters_ )[ t ].begin_trigger( modulation );
+
+            state.t_trig_ = t_trig;
+            state.modulation_ = modulation;
+            state.deliver_interval_ = deliver_interval;
+            state.dirty_ = false;
+            state.record_ = cache_->is_recorded();
+        }
+
+        changed = state.changed_;
+        return state.modulation_;
+    }
+
+    inline void ModulatoryCommonProperties::invalidate() const
+    {
+        if ( defer_invalidation_ )
+            return;
+
+        for ( auto & state: state_ )
+            state.dirty_ = true;
+    }
+
+    inline bool ModulatoryCommonProperties::get_lazy_modulation( nest::thread t,
+            unsigned int& epoch,
+            nest::long_t deliver_interval,
+            nest::double_t& modulation ) const
+    {
+        // no trigger yet on this thread 
+        if ( static_cast< size_t >( t ) >= state_.size() )
+            return false;
+
+        // nor since the model was bound to its volume transmitter
+        const ModulationState& state = state_[ t ];
+        if ( state.t_trig_ < 0 or state.epoch_ == epoch )
+            return false;
+
+        epoch = state.epoch_;
+        if ( deliver_interval == state.deliver_interval_ )
+            modulation = state.modulation_;
+        else
+            modulation = normalise( state, deliver_interval );
+        
+        return true;
+    }
+
+    inline nest::double_t ModulatoryCommonProperties::normalise( const ModulationState& state, 
+            nest::long_t deliver_interval ) const
+    {
+        nest::double_t input = use_trace() ? state.trace_ : state.num_spikes_;
+        if ( modulation_delay_ > 0 )
+            input = state.delayed_;
+
+        // replayed or rate modulations are already normalised
+        if ( normalised_signal_ )
+            return response( input );
+
+        // compute the ratio of spikes per deliver_interval between [0,1]
+        if ( not use_trace() )
+            return response( 2*input/(deliver_interval*max_modulation_) );
+        
+        // the trace is already a rate 
+        return response( 2*input/max_modulation_ );
+    }
+
+    inline nest::double_t ModulatoryCommonProperties::response( nest::double_t modulation ) const
+    {
+        const std::vector< nest::double_t >& table = function_.table_;
+        if ( table.empty() )
+            return modulation;
+
+        // saturate outside of the tabulated range
+        const nest::double_t x = ( modulation - function_.table_min_ )*function_.table_scale_;
+        if ( x <= 0 )
+            return table.front();
+        if ( x >= table.size() - 1 )
+            return table.back();
+
+        const size_t i = static_cast< size_t >( x );
+        return table[ i ] + ( x - i )*( table[ i + 1 ] - table[ i ] );
+    }
+
+    inline void ModulatoryCommonProperties::delay( nest::thread t, ModulationState& state ) const
+    {
+        // presized with state_ when the model is bound, each thread only
+        // touches its own line
+        std::vector< nest::double_t >& line = delay_lines_[ t ];
+        if ( line.size() != static_cast< size_t >( modulation_delay_ ) )
+        {
+            line.assign( modulation_delay_, 0.0 );
+            state.delay_head_ = 0;
+        }
+
+        nest::double_t& oldest = line[ state.delay_head_ ];
+        state.delayed_ = oldest;
+        oldest = use_trace() ? state.trace_ : state.num_spikes_;
+        state.delay_head_ = ( state.delay_head_ + 1 ) % line.size();
+    }
+
+    inline void ModulatoryCommonProperties::advance_trace( ModulationState& state, 
+            const std::vector< nest::spikecounter >& modulatory_spikes,
+            nest::double_t t_trig ) const
+    {
+        // decay from the previous trigger, then add each spike decayed from its own time 
+        nest::double_t trace = 0.0;
+        if ( state.t_trig_ >= 0 )
+            trace = state.trace_*std::exp( -( t_trig - state.t_trig_ )/tau_modulation_ );
+
+        for(const auto & sc: modulatory_spikes)
+            trace += sc.multiplicity_/tau_modulation_
+                *std::exp( -( t_trig - sc.spike_time_ )/tau_modulation_ );
+
+        state.trace_ = trace;
+    }
+
+    /**
+     * Modulation law of the generic modulatory synapse:
+     * the *modulation* directly multiplies the baseline weight.
+     *
+     * Modulation laws are policy classes from which ModulatoryConnection 
+     * inherits. They must define compute_modulation(), get_status() and 
+     * set_status() for their own parameters, and they should not define 
+     * virtual methods, so that synapses carry no vtable pointer and 
+     * compute_modulation() is inlined in the trigger loop.
+     * Their value_type is the type used to store weights and parameters
+     * in the synapse (double, or float for the compact models).
+     */
+    template < typename valueT = nest::double_t >
+    class IdentityModulation
+    {
+        public:
+
+            typedef valueT value_type;
+
+            nest::double_t compute_modulation( nest::double_t modulation ) const
+            {
+                return modulation;
+            }
+
+            void get_status( DictionaryDatum& ) const
+            {
+            }
+
+            void set_status( const DictionaryDatum& )
+            {
+            }
+    };
+
     /**
      * Modulatory connection
      * A third moduatory neuron can change the 
      * strength of the weights 
+     *
+     * @tparam modulationT policy giving the modulation law, see IdentityModulation 
+     * @tparam intervalT integer type used to store the deliver interval
      */
-    template < typename targetidentifierT >
-        class ModulatoryConnection : public nest::Connection< targetidentifierT >
+    template < typename targetidentifierT, 
+             typename modulationT = IdentityModulation<>, 
+             typename intervalT = int >
+        class ModulatoryConnection : public nest::Connection< targetidentifierT >, 
+                                     public modulationT
     {
+        public:
+            //! Type used to store weights
+            typedef typename modulationT::value_type value_type;
+
         private:
-            nest::double_t weight_baseline; //!< Initial synaptic weight
-            nest::double_t weight_; //!< Synaptic weight
-            nest::long_t deliver_interval; //!< deliver interval of the connected volume transmitter
+            value_type weight_baseline; //!< Initial synaptic weight
+            value_type weight_; //!< Synaptic weight
+            intervalT deliver_interval; //!< deliver interval of the connected volume transmitter
+            unsigned int epoch_; //!< modulation epoch weight_ was computed at, see lazy_weight
 
 
         public:
@@ -121,24 +893,21 @@ namespace mynest
              */
             ModulatoryConnection() 
                 : ConnectionBase()
-                  ,weight_(1.0)
                   ,weight_baseline(1.0)
+                  ,weight_(1.0)
                   ,deliver_interval(100)
+                  ,epoch_(0)
             {
                 weight_ = weight_baseline;
             }
 
             ModulatoryConnection( const ModulatoryConnection& rhs) 
                 : ConnectionBase(rhs)
-                  ,weight_(rhs.weight_ )
+                  ,modulationT(rhs)
                   ,weight_baseline(rhs.weight_baseline)
+                  ,weight_(rhs.weight_ )
                   ,deliver_interval(rhs.deliver_interval)
-            {
-            }
-
-
-            //! Default Destructor.
-            virtual ~ModulatoryConnection()
+                  ,epoch_(rhs.epoch_)
             {
             }
 
@@ -184,10 +953,13 @@ namespace mynest
                     nest::Node& t,
                     nest::rport receptor_type,
                     nest::double_t,
-                    const CommonPropertiesType& )
+                    const CommonPropertiesType& cp )
             {
                 ConnTestDummyNode dummy_target;
                 ConnectionBase::check_connection_( dummy_target, s, t, receptor_type );
+
+                // the new synapse gets its modulated weight at the next trigger
+                cp.invalidate();
             }
 
             /**
@@ -235,21 +1007,31 @@ namespace mynest
             {
                 weight_ = w;
             }
-
-            virtual nest::double_t compute_modulation(nest::double_t modulation)
-            {
-                return modulation;
-            }
     };
 
 
-    template < typename targetidentifierT >
-        inline void ModulatoryConnection< targetidentifierT >::send( nest::Event& e,
+    template < typename targetidentifierT, typename modulationT, typename intervalT >
+        inline void ModulatoryConnection< targetidentifierT, modulationT, intervalT >::send( nest::Event& e,
                 nest::thread t,
-                nest::double_t last,
+                nest::double_t,
                 const CommonPropertiesType& props )
         {
 
+            // with lazy_weight the weight is updated here, 
+            // only if the modulation changed since the last spike
+            nest::double_t modulation;
+            if ( props.lazy_weight_ 
+                    and props.get_lazy_modulation( t, epoch_, deliver_interval, modulation ) )
+                weight_ = props.clamp( weight_baseline*modulationT::compute_modulation(modulation), 
+                        weight_baseline );
+
+            // silenced synapses do not touch their target
+            if ( props.is_silenced( weight_ ) )
+                return;
+
+            if ( props.counters_ != 0 )
+                props.count_spike( t );
+
             // Even time stamp, we send the spike using the normal sending mechanism
             // send the spike to the target
             e.set_weight( weight_ );
@@ -260,47 +1042,82 @@ namespace mynest
 
         }
 
-    template < typename targetidentifierT >
-        void ModulatoryConnection< targetidentifierT >::get_status( DictionaryDatum& d ) const
+    template < typename targetidentifierT, typename modulationT, typename intervalT >
+        void ModulatoryConnection< targetidentifierT, modulationT, intervalT >::get_status( DictionaryDatum& d ) const
         {
             ConnectionBase::get_status( d );
             def< nest::double_t >( d, nest::names::weight, weight_ );
             def< nest::double_t >( d, "weight_baseline", weight_baseline );
             def< nest::long_t >( d, "deliver_interval", deliver_interval );
+            modulationT::get_status( d );
             def< nest::long_t >( d, nest::names::size_of, sizeof( *this ) );
         }
 
-    template < typename targetidentifierT >
-        void ModulatoryConnection< targetidentifierT >::set_status( const DictionaryDatum& d,
+    template < typename targetidentifierT, typename modulationT, typename intervalT >
+        void ModulatoryConnection< targetidentifierT, modulationT, intervalT >::set_status( const DictionaryDatum& d,
                 nest::ConnectorModel& cm )
         {
+            // the interval is narrowed to intervalT, check it before anything is changed
+            nest::long_t interval = deliver_interval;
+            updateValue< nest::long_t >( d, "deliver_interval", interval );
+            if ( interval < 1 or interval > std::numeric_limits< intervalT >::max() )
+                throw nest::BadProperty( "deliver_interval must be a positive "
+                        "number of min delays that fits the synapse." );
+
             ConnectionBase::set_status( d, cm );
             updateValue< nest::double_t >( d, nest::names::weight, weight_ );
             updateValue< nest::double_t >( d, "weight_baseline", weight_baseline );
-            updateValue< nest::long_t >( d, "deliver_interval", deliver_interval );
+            deliver_interval = interval;
+
+            modulationT::set_status( d );
+
+            // the changed synapse must not be skipped at the next trigger
+            static_cast< const CommonPropertiesType& >( 
+                    cm.get_common_properties() ).invalidate();
         }
     
-    template < typename targetidentifierT >
-        inline void ModulatoryConnection< targetidentifierT >::trigger_update_weight( 
+    template < typename targetidentifierT, typename modulationT, typename intervalT >
+        inline void ModulatoryConnection< targetidentifierT, modulationT, intervalT >::trigger_update_weight( 
                 nest::thread t,
                 const std::vector< nest::spikecounter >& modulatory_spikes,
                 const nest::double_t t_trig,
                 const CommonPropertiesType& cp )
         {     
             
-            nest::double_t num_spikes = 0;
-            for(const auto & sc: modulatory_spikes)
-                num_spikes += sc.multiplicity_;
+            // the ratio of spikes per deliver_interval is computed 
+            // once per thread and trigger and shared by all synapses
+            bool changed;
+            nest::double_t modulation = cp.get_modulation( t, modulatory_spikes, 
+                    t_trig, deliver_interval, changed );
 
-            // compute the ratio of spikes per deliver_interval between [0,1]
-            nest::double_t modulation =  2*num_spikes/(deliver_interval*cp.max_modulation_);
+            if ( cp.is_recording( t ) )
+                cp.record( t, this->get_syn_id(), modulatory_spikes, t_trig, 
+                        modulationT::compute_modulation( modulation ) );
+
+            if ( cp.counters_ != 0 )
+                cp.count_synapses( t, 1, changed and not cp.lazy_weight_ );
+
+            // nothing to rewrite if the weight would stay the same, 
+            // or if it will be computed on the next spike
+            if ( not changed or cp.lazy_weight_ )
+                return;
 
             // update the weight based on a function of the ratio 
-            // given by the compute_modulation() method
-            weight_ = weight_baseline*compute_modulation(modulation);
+            // given by the compute_modulation() method of the policy
+            weight_ = cp.clamp( weight_baseline*modulationT::compute_modulation(modulation), 
+                    weight_baseline );
           
         }
 
+    /*
+     *  Compact variant of the modulatory synapse, meant to be used with 
+     *  nest::TargetIdentifierIndex. Weights are stored in single 
+     *  precision and the deliver interval in 32 bits.
+     */
+    template < typename targetidentifierT >
+        using ModulatoryHPCConnection = ModulatoryConnection< targetidentifierT, 
+              IdentityModulation< float >, int >;
+
 } // namespace nest
 
 #endif // MODULATORY_CONNECTION
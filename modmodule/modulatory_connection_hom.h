@@ -0,0 +1,363 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+/*
+ *  The class ModulatoryHomConnection implements modulatory synapses in which all 
+ *  the connections of a model share the same parameters (as in static_synapse_hom_w).
+ *  The baseline weight, the parameters of the modulation law, the deliver interval 
+ *  and the current modulated weight are stored in the common properties, so that 
+ *  each synapse only holds its target and delay and the weight is computed only 
+ *  once per thread and trigger.
+ *
+ *  The parameters can only be changed for the whole model, through SetDefaults or CopyModel.
+ *
+ *  Parameters (common to all synapses):
+ *      weight_baseline =>  the baseline value which has to be multiplied times the *modulation* 
+ *      deliver_interval => deliver interval of the connected volume transmitter
+ *      alpha => amplitude of the modulation (d1, d2 and d2_div models only)
+ */
+
+#ifndef MODULATORY_CONNECTION_HOM
+#define MODULATORY_CONNECTION_HOM
+
+#include "connection.h"
+#include "modulatory_connection.h"
+#include "da_connection.h"
+#include <algorithm>
+#include <vector>
+
+namespace mynest
+{
+
+    /**
+     * Modulated weight of one thread.
+     * Aligned to a cache line so that threads never share one.
+     */
+    struct alignas( CACHE_LINE_SIZE ) ModulatedWeight
+    {
+        ModulatedWeight()
+            : weight_(1.0)
+        {
+        }
+
+        nest::double_t weight_;
+    };
+
+    /**
+     * Class containing the common properties of the homogeneous modulatory synapses,
+     * including their parameters and their current weight.
+     *
+     * @tparam modulationT policy giving the modulation law, see IdentityModulation 
+     */
+    template < typename modulationT >
+        class ModulatoryHomCommonProperties : public ModulatoryCommonProperties, 
+                                              public modulationT
+    {
+        private:
+            nest::double_t weight_baseline_; //!< Initial synaptic weight
+            nest::long_t deliver_interval_; //!< deliver interval of the connected volume transmitter
+
+            /**
+             * Per-thread modulated weight, sized to the threads of the 
+             * network by the constructor and by set_status, which binds 
+             * the model to its volume transmitter: the triggers only 
+             * write the entry of their own thread.
+             */
+            mutable std::vector< ModulatedWeight, CacheLineAllocator< ModulatedWeight > > weight_;
+
+        public:
+
+            /**
+             * Default constructor.
+             * Sets all property values to defaults.
+             */
+            ModulatoryHomCommonProperties()
+                : ModulatoryCommonProperties()
+                  ,modulationT()
+                  ,weight_baseline_(1.0)
+                  ,deliver_interval_(100)
+                  ,weight_( nest::NestModule::get_network().get_num_threads() )
+            {
+            }
+
+            /**
+             * Get all properties and put them into a dictionary.
+             */
+            void get_status( DictionaryDatum& d ) const;
+
+            /**
+             * Set properties from the values given in dictionary.
+             */
+            void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm );
+
+            /**
+             * Recompute the weight of thread t if the modulation changed at t_trig.
+             * Only the first synapse triggered on the thread does any work.
+             * syn_id is the model of the triggered synapse.
+             */
+            void update_weight( nest::thread t,
+                    nest::synindex syn_id,
+                    const std::vector< nest::spikecounter >& modulatory_spikes,
+                    nest::double_t t_trig ) const;
+
+            //! Current modulated weight on thread t
+            nest::double_t get_weight( nest::thread t ) const
+            {
+                // threads that were never triggered see the baseline 
+                if ( static_cast< size_t >( t ) >= weight_.size() )
+                    return weight_baseline_;
+                return weight_[ t ].weight_;
+            }
+
+        private:
+
+            //! Recompute the weights of all threads from their last modulation
+            void reset_weights();
+    };
+
+    template < typename modulationT >
+        void ModulatoryHomCommonProperties< modulationT >::get_status( DictionaryDatum& d ) const
+        {
+            ModulatoryCommonProperties::get_status( d );
+            modulationT::get_status( d );
+            def< nest::double_t >( d, "weight_baseline", weight_baseline_ );
+            def< nest::long_t >( d, "deliver_interval", deliver_interval_ );
+
+            // all threads see the same modulation, report the one 
+            // of the thread that was triggered last
+            size_t last = 0;
+            for ( size_t t = 1; t < state_.size() && t < weight_.size(); ++t )
+                if ( state_[ t ].t_trig_ > state_[ last ].t_trig_ )
+                    last = t;
+            def< nest::double_t >( d, nest::names::weight, weight_[ last ].weight_ );
+        }
+
+    template < typename modulationT >
+        void ModulatoryHomCommonProperties< modulationT >::set_status( const DictionaryDatum& d,
+                nest::ConnectorModel& cm )
+        {
+            // reject the call before anything is changed
+            if ( d->known( nest::names::weight ) )
+                throw nest::BadProperty( "The weight of homogeneous modulatory synapses "
+                        "is computed from weight_baseline and the modulation." );
+
+            nest::long_t interval = deliver_interval_;
+            if ( updateValue< nest::long_t >( d, "deliver_interval", interval ) and interval < 1 )
+                throw nest::BadProperty( "deliver_interval must be a positive number of min delays." );
+
+            ModulatoryCommonProperties::set_status( d, cm );
+            modulationT::set_status( d );
+            updateValue< nest::double_t >( d, "weight_baseline", weight_baseline_ );
+            deliver_interval_ = interval;
+
+            reset_weights();
+        }
+
+    template < typename modulationT >
+        void ModulatoryHomCommonProperties< modulationT >::reset_weights()
+        {
+            const size_t num_threads = std::max( state_.size(), 
+                    static_cast< size_t >( nest::NestModule::get_network().get_num_threads() ) );
+            weight_.resize( num_threads );
+            
+            // before the first trigger the weight is not modulated
+            for ( size_t t = 0; t < num_threads; ++t )
+                weight_[ t ].weight_ = ( t < state_.size() && state_[ t ].t_trig_ >= 0 ) 
+                    ? clamp( weight_baseline_*modulationT::compute_modulation( state_[ t ].modulation_ ),
+                            weight_baseline_ )
+                    : weight_baseline_;
+        }
+
+    template < typename modulationT >
+        inline void ModulatoryHomCommonProperties< modulationT >::update_weight( 
+                nest::thread t,
+                nest::synindex syn_id,
+                const std::vector< nest::spikecounter >& modulatory_spikes,
+                nest::double_t t_trig ) const
+        {
+            bool changed;
+            nest::double_t modulation = get_modulation( t, modulatory_spikes, 
+                    t_trig, deliver_interval_, changed );
+
+            if ( is_recording( t ) )
+                record( t, syn_id, modulatory_spikes, t_trig, 
+                        modulationT::compute_modulation( modulation ) );
+            
+            if ( counters_ != 0 )
+                count_synapses( t, 1, changed );
+
+            if ( changed )
+                weight_[ t ].weight_ = clamp( weight_baseline_*modulationT::compute_modulation( modulation ), 
+                        weight_baseline_ );
+        }
+
+    /**
+     * Homogeneous modulatory connection
+     * A third moduatory neuron can change the 
+     * strength of the weights, which are the same for all 
+     * the synapses of the model.
+     *
+     * @tparam modulationT policy giving the modulation law, see IdentityModulation 
+     */
+    template < typename targetidentifierT, typename modulationT = IdentityModulation<> >
+        class ModulatoryHomConnection : public nest::Connection< targetidentifierT >
+    {
+        public:
+            //! Type to use for representing common synapse properties
+            typedef ModulatoryHomCommonProperties< modulationT > CommonPropertiesType;
+
+            //! Shortcut for base class
+            typedef nest::Connection< targetidentifierT > ConnectionBase;
+
+            /**
+             * Default Constructor.
+             * Sets default values for all parameters. Needed by GenericConnectorModel.
+             */
+            ModulatoryHomConnection() 
+                : ConnectionBase()
+            {
+            }
+
+            /**
+             * Helper class defining which types of events can be transmitted.
+             * See ModulatoryConnection::ConnTestDummyNode.
+             */
+            class ConnTestDummyNode 
+                : public nest::ConnTestDummyNodeBase 
+            {
+                public:
+                    using nest::ConnTestDummyNodeBase::handles_test_event;
+                    nest::port handles_test_event( nest::SpikeEvent&, nest::rport )
+                    {
+                        return nest::invalid_port_;
+                    }
+            };
+
+            /**
+             * Check that requested connection can be created.
+             * See ModulatoryConnection::check_connection().
+             */
+            void check_connection( nest::Node& s,
+                    nest::Node& t,
+                    nest::rport receptor_type,
+                    nest::double_t,
+                    const CommonPropertiesType& )
+            {
+                ConnTestDummyNode dummy_target;
+                ConnectionBase::check_connection_( dummy_target, s, t, receptor_type );
+            }
+
+            /**
+             * Send an event to the receiver of this connection.
+             * @param e The event to send
+             * @param t Thread
+             * @param t_lastspike Point in time of last spike sent.
+             * @param cp Common properties to all synapses, holding the weight.
+             */
+            void send( nest::Event& e,
+                    nest::thread t,
+                    nest::double_t,
+                    const CommonPropertiesType& cp )
+            {
+                const nest::double_t weight = cp.get_weight( t );
+                
+                // silenced synapses do not touch their target
+                if ( cp.is_silenced( weight ) )
+                    return;
+
+                if ( cp.counters_ != 0 )
+                    cp.count_spike( t );
+
+                e.set_weight( weight );
+                e.set_delay( ConnectionBase::get_delay_steps() );
+                e.set_receiver( *ConnectionBase::get_target( t ) );
+                e.set_rport( ConnectionBase::get_rport() );
+                e(); // this sends the event
+            }
+
+            /**
+             * triggers an update of the weight common to all synapses 
+             * @param t Thread
+             * @param modulatory_spikes counter of modulatory spikes
+             * @param t_trig update triggering time 
+             * @param cp Common properties to all synapses.
+             */
+            void trigger_update_weight( nest::thread t,
+                    const std::vector< nest::spikecounter >& modulatory_spikes,
+                    nest::double_t t_trig,
+                    const CommonPropertiesType& cp )
+            {
+                cp.update_weight( t, this->get_syn_id(), modulatory_spikes, t_trig );
+            }
+
+            //! Store connection status information in dictionary
+            void get_status( DictionaryDatum& d ) const
+            {
+                ConnectionBase::get_status( d );
+                def< nest::long_t >( d, nest::names::size_of, sizeof( *this ) );
+            }
+
+            /**
+             * Set connection status.
+             *
+             * @param d Dictionary with new parameter values
+             * @param cm ConnectorModel is passed along to validate new delay values
+             */
+            void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm )
+            {
+                if ( d->known( nest::names::weight ) || d->known( "weight_baseline" ) 
+                        || d->known( "alpha" ) || d->known( "deliver_interval" ) )
+                    throw nest::BadProperty( "Setting of individual parameters is not possible "
+                            "for homogeneous modulatory synapses. The common parameters "
+                            "can be changed via CopyModel()." );
+
+                ConnectionBase::set_status( d, cm );
+            }
+
+            //! Individual weights are not supported
+            void set_weight( nest::double_t )
+            {
+                throw nest::BadProperty( "Setting of individual weights is not possible "
+                        "for homogeneous modulatory synapses. The common weight_baseline "
+                        "can be changed via CopyModel()." );
+            }
+    };
+
+    /*
+    *  Homogeneous variants of the modulatory synapses (see da_connection.h)
+    */
+    template < typename targetidentifierT >
+        using D1HomConnection = ModulatoryHomConnection< targetidentifierT, D1Modulation<> >;
+    
+    template < typename targetidentifierT >
+        using D2HomConnection = ModulatoryHomConnection< targetidentifierT, D2Modulation<> >;
+    
+    template < typename targetidentifierT >
+        using D2DivHomConnection = ModulatoryHomConnection< targetidentifierT, D2DivModulation<> >;
+
+} // namespace nest
+
+#endif // MODULATORY_CONNECTION_HOM
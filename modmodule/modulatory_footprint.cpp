@@ -0,0 +1,144 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+#include "network.h"
+#include "dictdatum.h"
+#include "dictutils.h"
+#include "arraydatum.h"
+#include "connector_model.h"
+#include "nestmodule.h"
+#include "modulatory_footprint.h"
+
+#include <set>
+#include <vector>
+
+namespace mynest
+{
+    namespace
+    {
+        //! Models of this module have the scale of their modulation in their defaults
+        bool is_modulatory_model( const DictionaryDatum& defaults )
+        {
+            return defaults->known( "max_modulation" ) 
+                or defaults->known( "max_modulations" ) 
+                or defaults->known( "max_concentration" );
+        }
+
+        //! Gids of the nodes triggering the synapses of a model, -1 if not set
+        std::vector< nest::long_t > get_trigger_gids( const DictionaryDatum& defaults )
+        {
+            std::vector< nest::long_t > gids;
+            if ( defaults->known( "vts" ) )
+                gids = getValue< std::vector< nest::long_t > >( defaults, "vts" );
+            else if ( defaults->known( "field" ) )
+                gids.push_back( getValue< nest::long_t >( defaults, "field" ) );
+            else
+                gids.push_back( getValue< nest::long_t >( defaults, "vt" ) );
+            return gids;
+        }
+    }
+
+    DictionaryDatum get_modulatory_footprint()
+    {
+        nest::Network& net = nest::NestModule::get_network();
+        const nest::thread num_threads = net.get_num_threads();
+
+        ArrayDatum models;
+        std::set< nest::long_t > vts;
+        nest::long_t total_bytes = 0;
+
+        const Dictionary& synapsedict = net.get_synapsedict();
+        for ( Dictionary::const_iterator it = synapsedict.begin(); 
+                it != synapsedict.end(); ++it )
+        {
+            const nest::index syn_id = getValue< nest::long_t >( it->second );
+            DictionaryDatum defaults = net.get_synapse_defaults( syn_id );
+            if ( not is_modulatory_model( defaults ) )
+                continue;
+
+            const std::string name = it->first.toString();
+            const nest::long_t size_of = getValue< nest::long_t >( defaults, nest::names::size_of );
+
+            // the prototype of each thread counts the synapses it created
+            std::vector< nest::long_t > synapses( num_threads, 0 );
+            nest::long_t num_synapses = 0;
+            for ( nest::thread t = 0; t < num_threads; ++t )
+            {
+                synapses[ t ] = net.get_synapse_prototype( syn_id, t ).get_num_connections();
+                num_synapses += synapses[ t ];
+            }
+            const nest::long_t bytes = num_synapses*size_of;
+            total_bytes += bytes;
+
+            DictionaryDatum model( new Dictionary );
+            def< std::string >( model, "model", name );
+            def< std::vector< nest::long_t > >( model, "synapses", synapses );
+            def< nest::long_t >( model, "num_synapses", num_synapses );
+            def< nest::long_t >( model, "size_of", size_of );
+            def< nest::long_t >( model, "total_bytes", bytes );
+
+            // every trigger of a volume transmitter sweeps all the synapses
+            // of the models bound to it, on every thread
+            const std::vector< nest::long_t > gids = get_trigger_gids( defaults );
+            std::vector< nest::double_t > trigger_intervals;
+            for ( size_t c = 0; c < gids.size(); ++c )
+            {
+                if ( gids[ c ] < 0 )
+                    continue;
+                vts.insert( gids[ c ] );
+
+                DictionaryDatum status = net.get_status( gids[ c ] );
+                if ( status->known( "deliver_interval" ) )
+                    trigger_intervals.push_back( nest::Time( nest::Time::step( 
+                                    getValue< nest::long_t >( status, "deliver_interval" )
+                                    *net.get_min_delay() ) ).get_ms() );
+            }
+            def< std::vector< nest::long_t > >( model, "vts", gids );
+            def< std::vector< nest::double_t > >( model, "trigger_intervals", trigger_intervals );
+            def< nest::long_t >( model, "trigger_synapses", num_synapses );
+            def< nest::long_t >( model, "trigger_bytes", bytes );
+
+            // with instrument the measured cost replaces the estimate
+            if ( defaults->known( "num_triggers" ) )
+            {
+                const nest::long_t triggers = getValue< nest::long_t >( defaults, "num_triggers" );
+                if ( triggers > 0 )
+                    def< nest::double_t >( model, "trigger_time", 
+                            getValue< nest::double_t >( defaults, "trigger_time" )/triggers );
+            }
+
+            models.push_back( model );
+        }
+
+        DictionaryDatum footprint( new Dictionary );
+        def< nest::long_t >( footprint, "num_threads", num_threads );
+        def< nest::long_t >( footprint, "num_volume_transmitters", vts.size() );
+        def< nest::long_t >( footprint, "total_bytes", total_bytes );
+        def< ArrayDatum >( footprint, "models", models );
+        return footprint;
+    }
+
+} // of namespace nest
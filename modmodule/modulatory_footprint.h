@@ -0,0 +1,59 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+/*
+ *  Memory footprint and trigger load of the modulatory synapses.
+ *
+ *  get_modulatory_footprint() reports, for each model of this module and
+ *  each of their copies, the synapses held by each thread of this process,
+ *  the bytes they take, and the synapses swept by the triggers of their 
+ *  volume transmitter, so that the memory and the trigger load of a larger
+ *  run can be extrapolated from a small one.
+ *
+ *  The synapses are counted by the prototype of each model on each thread,
+ *  without listing the connections, so the report is cheap on any network.
+ *  The connectors holding the synapses are private to the ConnectionManager
+ *  of NEST 2.10 and are not included in the bytes.
+ */
+
+#ifndef MODULATORY_FOOTPRINT_H
+#define MODULATORY_FOOTPRINT_H
+
+#include "dictdatum.h"
+
+namespace mynest
+{
+
+    /**
+     * Report the footprint of the modulatory models on this process.
+     * @return dictionary with num_threads, num_volume_transmitters, 
+     *         total_bytes and a dictionary per model in models
+     */
+    DictionaryDatum get_modulatory_footprint();
+
+} // namespace mynest
+
+#endif // MODULATORY_FOOTPRINT_H
@@ -0,0 +1,239 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+#include "network.h"
+#include "dictdatum.h"
+#include "dictutils.h"
+#include "arraydatum.h"
+#include "connectiondatum.h"
+#include "connector_model.h"
+#include "exceptions.h"
+#include "nestmodule.h"
+#include "modulatory_connection.h"
+#include "multi_modulatory_connection.h"
+#include "modulatory_parameters.h"
+
+#include <exception>
+#include <set>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace mynest
+{
+    namespace
+    {
+        /**
+         * A connection to be accessed, with its position in the buffer.
+         */
+        struct ParameterEntry
+        {
+            nest::index source_;
+            nest::index syn_id_;
+            nest::port port_;
+            size_t position_;
+        };
+
+        void check_parameter_name( const std::string& name )
+        {
+            if ( name != "weight_baseline" and name != "alpha" and name != "weight" )
+                throw nest::BadProperty( "Only weight_baseline, alpha and weight can be "
+                        "accessed in bulk." );
+        }
+
+        /**
+         * Sort the connections by the thread of their target. Connections are 
+         * either ConnectionDatum or arrays [source, target, thread, synapse_modelid, port].
+         */
+        std::vector< std::vector< ParameterEntry > > split_by_thread( 
+                const ArrayDatum& connections, nest::thread num_threads )
+        {
+            std::vector< std::vector< ParameterEntry > > entries( num_threads );
+            for ( size_t i = 0; i < connections.size(); ++i )
+            {
+                ParameterEntry entry;
+                nest::long_t thread;
+                
+                ConnectionDatum* conn = dynamic_cast< ConnectionDatum* >( connections[ i ].datum() );
+                if ( conn != 0 )
+                {
+                    entry.source_ = conn->get_source_gid();
+                    entry.syn_id_ = conn->get_synapse_model_id();
+                    entry.port_ = conn->get_port();
+                    thread = conn->get_target_thread();
+                }
+                else
+                {
+                    const std::vector< nest::long_t > id = 
+                        getValue< std::vector< nest::long_t > >( connections[ i ] );
+                    if ( id.size() != 5 )
+                        throw nest::BadProperty( "Connections must be given as returned "
+                                "by GetConnections." );
+                    entry.source_ = id[ 0 ];
+                    thread = id[ 2 ];
+                    entry.syn_id_ = id[ 3 ];
+                    entry.port_ = id[ 4 ];
+                }
+
+                if ( thread < 0 or thread >= num_threads )
+                    throw nest::BadProperty( "Connection of a thread that does not exist." );
+
+                entry.position_ = i;
+                entries[ thread ].push_back( entry );
+            }
+            return entries;
+        }
+
+        nest::thread get_omp_thread()
+        {
+#ifdef _OPENMP
+            return omp_get_thread_num();
+#else
+            return 0;
+#endif
+        }
+
+        /**
+         * Force the synapses of a model to update their weight at the next 
+         * trigger, without going through set_status. The multi-modulatory 
+         * models of the module have two channels; the other models are 
+         * not lazy and are left alone.
+         */
+        void invalidate( const nest::ConnectorModel& model )
+        {
+            const nest::CommonSynapseProperties& cp = model.get_common_properties();
+            if ( const ModulatoryCommonProperties* props = 
+                    dynamic_cast< const ModulatoryCommonProperties* >( &cp ) )
+                props->invalidate();
+            else if ( const MultiModulatoryCommonProperties< 2 >* props = 
+                    dynamic_cast< const MultiModulatoryCommonProperties< 2 >* >( &cp ) )
+                props->invalidate();
+        }
+    }
+
+    void get_modulatory_parameters( const ArrayDatum& connections, 
+            const std::string& name,
+            std::vector< double >& values )
+    {
+        check_parameter_name( name );
+
+        nest::Network& net = nest::NestModule::get_network();
+        const nest::thread num_threads = net.get_num_threads();
+        const std::vector< std::vector< ParameterEntry > > entries = 
+            split_by_thread( connections, num_threads );
+
+        values.resize( connections.size() );
+
+        // Names are entered in the global table of SLI, which is not 
+        // thread safe: create them before the parallel region
+        const Name parameter( name );
+
+        // each thread reads the synapses it owns into its own positions 
+        std::vector< std::exception_ptr > errors( num_threads );
+#pragma omp parallel
+        {
+            const nest::thread t = get_omp_thread();
+            try
+            {
+                for ( const auto & entry: entries[ t ] )
+                {
+                    DictionaryDatum status = net.get_synapse_status( entry.source_, 
+                            entry.syn_id_, entry.port_, t );
+                    if ( not status->known( parameter ) )
+                        throw nest::BadProperty( "The synapse has no parameter " + name + "." );
+                    values[ entry.position_ ] = getValue< nest::double_t >( status, parameter );
+                }
+            }
+            catch ( ... )
+            {
+                errors[ t ] = std::current_exception();
+            }
+        }
+        for ( nest::thread t = 0; t < num_threads; ++t )
+            if ( errors[ t ] )
+                std::rethrow_exception( errors[ t ] );
+    }
+
+    void set_modulatory_parameters( const ArrayDatum& connections,
+            const std::string& name,
+            const std::vector< double >& values )
+    {
+        check_parameter_name( name );
+
+        if ( values.size() != connections.size() )
+            throw nest::BadProperty( "One value per connection is needed." );
+
+        nest::Network& net = nest::NestModule::get_network();
+        const nest::thread num_threads = net.get_num_threads();
+        const std::vector< std::vector< ParameterEntry > > entries = 
+            split_by_thread( connections, num_threads );
+
+        // created before the parallel region, see get_modulatory_parameters()
+        const Name parameter( name );
+
+        // every set_status would invalidate the common properties shared 
+        // by all threads, the models are invalidated once at the end
+        ModulatoryCommonProperties::defer_invalidation_ = true;
+
+        std::vector< std::exception_ptr > errors( num_threads );
+#pragma omp parallel
+        {
+            const nest::thread t = get_omp_thread();
+            try
+            {
+                // one dictionary per thread, only its value changes 
+                DictionaryDatum params( new Dictionary );
+                for ( const auto & entry: entries[ t ] )
+                {
+                    def< nest::double_t >( params, parameter, values[ entry.position_ ] );
+                    net.set_synapse_status( entry.source_, entry.syn_id_, entry.port_, t, params );
+                }
+            }
+            catch ( ... )
+            {
+                errors[ t ] = std::current_exception();
+            }
+        }
+        ModulatoryCommonProperties::defer_invalidation_ = false;
+
+        // the changed synapses must not be skipped at the next trigger, 
+        // each thread has its own copy of the common properties
+        std::set< nest::index > models;
+        for ( const auto & thread_entries: entries )
+            for ( const auto & entry: thread_entries )
+                models.insert( entry.syn_id_ );
+        for ( const auto syn_id: models )
+            for ( nest::thread t = 0; t < num_threads; ++t )
+                invalidate( net.get_synapse_prototype( syn_id, t ) );
+
+        for ( nest::thread t = 0; t < num_threads; ++t )
+            if ( errors[ t ] )
+                std::rethrow_exception( errors[ t ] );
+    }
+
+} // namespace mynest
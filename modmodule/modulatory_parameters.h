@@ -0,0 +1,71 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+/*
+ *  Bulk access to the parameters of the modulatory synapses.
+ *
+ *  get_modulatory_parameters() and set_modulatory_parameters() read or write
+ *  one parameter (weight_baseline, alpha or weight) of a whole set of
+ *  connections, as returned by GetConnections, from or to a contiguous 
+ *  array of doubles in the order of the connections. Each thread handles 
+ *  the connections whose targets it owns, in parallel, without going 
+ *  through the interpreter for every synapse.
+ *
+ *  NEST 2.10 keeps the connectors in its ConnectionManager, out of reach of
+ *  a module, so each synapse is still read and written through the 
+ *  get_synapse_status/set_synapse_status of the kernel. Writing reuses one
+ *  dictionary per thread; reading gets one from the kernel per synapse.
+ */
+
+#ifndef MODULATORY_PARAMETERS_H
+#define MODULATORY_PARAMETERS_H
+
+#include "arraydatum.h"
+#include <string>
+#include <vector>
+
+namespace mynest
+{
+
+    /**
+     * Read the parameter name of the given connections into values,
+     * which is resized to the number of connections.
+     */
+    void get_modulatory_parameters( const ArrayDatum& connections, 
+            const std::string& name,
+            std::vector< double >& values );
+
+    /**
+     * Set the parameter name of the given connections, values must
+     * hold one value per connection.
+     */
+    void set_modulatory_parameters( const ArrayDatum& connections,
+            const std::string& name,
+            const std::vector< double >& values );
+
+} // namespace mynest
+
+#endif // MODULATORY_PARAMETERS_H
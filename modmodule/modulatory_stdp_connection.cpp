@@ -0,0 +1,97 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+#include "network.h"
+#include "dictdatum.h"
+#include "connector_model.h"
+#include "exceptions.h"
+#include "modulatory_stdp_connection.h"
+
+namespace mynest
+{
+    //
+    // Implementation of class ModulatoryStdpCommonProperties.
+    //
+
+    ModulatoryStdpCommonProperties::ModulatoryStdpCommonProperties()
+        : ModulatoryCommonProperties(),
+        A_plus_( 1.0 ),
+        A_minus_( 1.5 ),
+        tau_plus_( 20.0 ),
+        tau_c_( 1000.0 ),
+        tau_n_( 200.0 ),
+        b_( 0.0 ),
+        Wmin_( 0.0 ),
+        Wmax_( 200.0 )
+    {
+    }
+
+    void ModulatoryStdpCommonProperties::get_status( DictionaryDatum& d ) const
+    {
+        ModulatoryCommonProperties::get_status( d );
+        def< nest::double_t >( d, "A_plus", A_plus_ );
+        def< nest::double_t >( d, "A_minus", A_minus_ );
+        def< nest::double_t >( d, "tau_plus", tau_plus_ );
+        def< nest::double_t >( d, "tau_c", tau_c_ );
+        def< nest::double_t >( d, "tau_n", tau_n_ );
+        def< nest::double_t >( d, "b", b_ );
+        def< nest::double_t >( d, "Wmin", Wmin_ );
+        def< nest::double_t >( d, "Wmax", Wmax_ );
+    }
+
+    void ModulatoryStdpCommonProperties::set_status( const DictionaryDatum& d, 
+            nest::ConnectorModel& cm )
+    {
+        // validate on copies, so that a bad value leaves the model untouched
+        nest::double_t tau_plus = tau_plus_;
+        nest::double_t tau_c = tau_c_;
+        nest::double_t tau_n = tau_n_;
+        nest::double_t Wmin = Wmin_;
+        nest::double_t Wmax = Wmax_;
+        updateValue< nest::double_t >( d, "tau_plus", tau_plus );
+        updateValue< nest::double_t >( d, "tau_c", tau_c );
+        updateValue< nest::double_t >( d, "tau_n", tau_n );
+        updateValue< nest::double_t >( d, "Wmin", Wmin );
+        updateValue< nest::double_t >( d, "Wmax", Wmax );
+
+        if ( tau_plus <= 0 or tau_c <= 0 or tau_n <= 0 )
+            throw nest::BadProperty( "tau_plus, tau_c and tau_n must be positive." );
+        if ( Wmin > Wmax )
+            throw nest::BadProperty( "Wmin must not be larger than Wmax." );
+
+        ModulatoryCommonProperties::set_status( d, cm );
+
+        updateValue< nest::double_t >( d, "A_plus", A_plus_ );
+        updateValue< nest::double_t >( d, "A_minus", A_minus_ );
+        updateValue< nest::double_t >( d, "b", b_ );
+        tau_plus_ = tau_plus;
+        tau_c_ = tau_c;
+        tau_n_ = tau_n;
+        Wmin_ = Wmin;
+        Wmax_ = Wmax;
+    }
+
+} // of namespace nest
@@ -0,0 +1,443 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+/*
+ *  The class ModulatoryStdpConnection fuses in a single synapse the dopamine 
+ *  gated STDP of NEST's stdp_dopamine_synapse (Izhikevich 2007, Potjans et al. 
+ *  2010) and the direct modulation of the d1, d2 and d2_div synapses, so that 
+ *  a corticostriatal pair needs one connection, one event per spike and one 
+ *  trigger per interval instead of two parallel connections on the same 
+ *  volume transmitter.
+ *
+ *  The synapse learns its weight as stdp_dopamine_synapse does, from the 
+ *  eligibility trace c of the pre and post spikes and the dopamine trace n 
+ *  of the spikes of the volume transmitter:
+ *
+ *      dw/dt = c*(n - b),  Wmin <= w <= Wmax
+ *
+ *  and delivers its spikes with the learned weight passed through the 
+ *  modulation law of the last modulation of the volume transmitter:
+ *
+ *      delivered weight = w*f(modulation)    (see da_connection.h)
+ *
+ *  The target must keep the history of its spikes (archiving nodes, e.g. 
+ *  iaf_psc_exp), and the model must be bound to a volume transmitter, whose
+ *  spike times drive the dopamine trace.
+ *
+ *  Parameters (common to all synapses), besides those of the modulatory synapses:
+ *      A_plus, A_minus => amplitudes of the facilitation and of the depression
+ *      tau_plus => time constant of the presynaptic trace (ms)
+ *      tau_c => time constant of the eligibility trace (ms)
+ *      tau_n => time constant of the dopamine trace (ms)
+ *      b => dopamine baseline
+ *      Wmin, Wmax => bounds of the learned weight
+ *
+ *  Parameters (of each synapse):
+ *      weight => the learned weight
+ *      deliver_interval => deliver interval of the connected volume transmitter
+ *      alpha => amplitude of the modulation (d1, d2 and d2_div laws only)
+ *      c, n => eligibility and dopamine traces (read only)
+ */
+
+#ifndef MODULATORY_STDP_CONNECTION
+#define MODULATORY_STDP_CONNECTION
+
+#include "connection.h"
+#include "histentry.h"
+#include "numerics.h"
+#include "modulatory_connection.h"
+#include "da_connection.h"
+#include <cmath>
+#include <deque>
+#include <vector>
+
+namespace mynest
+{
+
+    /**
+     * Class containing the common properties of the fused STDP modulatory synapses.
+     */
+    class ModulatoryStdpCommonProperties : public ModulatoryCommonProperties
+    {
+        public:
+
+            ModulatoryStdpCommonProperties();
+
+            void get_status( DictionaryDatum& d ) const;
+
+            void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm );
+
+            nest::double_t A_plus_;
+            nest::double_t A_minus_;
+            nest::double_t tau_plus_;
+            nest::double_t tau_c_;
+            nest::double_t tau_n_;
+            nest::double_t b_;
+            nest::double_t Wmin_;
+            nest::double_t Wmax_;
+    };
+
+    /**
+     * Modulatory STDP connection
+     * Dopamine gated STDP learns the weight, which 
+     * the modulation scales at delivery
+     *
+     * @tparam modulationT policy giving the modulation law, see IdentityModulation 
+     */
+    template < typename targetidentifierT, typename modulationT = IdentityModulation<> >
+        class ModulatoryStdpConnection : public nest::Connection< targetidentifierT >, 
+                                         public modulationT
+    {
+        public:
+            //! Type to use for representing common synapse properties
+            typedef ModulatoryStdpCommonProperties CommonPropertiesType;
+
+            //! Shortcut for base class
+            typedef nest::Connection< targetidentifierT > ConnectionBase;
+
+        private:
+            nest::double_t weight_; //!< learned synaptic weight
+            nest::double_t Kplus_; //!< presynaptic trace 
+            nest::double_t c_; //!< eligibility trace
+            nest::double_t n_; //!< dopamine trace, at the time of the last dopamine spike
+            size_t dopa_spikes_idx_; //!< last dopamine spike processed in the current interval
+            nest::double_t t_last_update_; //!< time the traces refer to
+            nest::long_t deliver_interval; //!< deliver interval of the connected volume transmitter
+
+        public:
+
+            /**
+             * Default Constructor.
+             * Sets default values for all parameters. Needed by GenericConnectorModel.
+             */
+            ModulatoryStdpConnection() 
+                : ConnectionBase()
+                  ,modulationT()
+                  ,weight_(1.0)
+                  ,Kplus_(0.0)
+                  ,c_(0.0)
+                  ,n_(0.0)
+                  ,dopa_spikes_idx_(0)
+                  ,t_last_update_(0.0)
+                  ,deliver_interval(100)
+            {
+            }
+
+            /**
+             * Helper class defining which types of events can be transmitted.
+             * See ModulatoryConnection::ConnTestDummyNode.
+             */
+            class ConnTestDummyNode 
+                : public nest::ConnTestDummyNodeBase 
+            {
+                public:
+                    using nest::ConnTestDummyNodeBase::handles_test_event;
+                    nest::port handles_test_event( nest::SpikeEvent&, nest::rport )
+                    {
+                        return nest::invalid_port_;
+                    }
+            };
+
+            /**
+             * Check that requested connection can be created, and ask the 
+             * target to keep the history of its spikes from t_lastspike on.
+             */
+            void check_connection( nest::Node& s,
+                    nest::Node& t,
+                    nest::rport receptor_type,
+                    nest::double_t t_lastspike,
+                    const CommonPropertiesType& cp )
+            {
+                if ( cp.vt_ == 0 )
+                    throw nest::BadProperty( "No volume transmitter has been assigned "
+                            "to the modulatory STDP synapse." );
+
+                ConnTestDummyNode dummy_target;
+                ConnectionBase::check_connection_( dummy_target, s, t, receptor_type );
+
+                t.register_stdp_connection( t_lastspike - ConnectionBase::get_delay() );
+            }
+
+            /**
+             * Update the weight up to the spike, then send the event 
+             * with the modulated weight.
+             * @param e The event to send
+             * @param t Thread
+             * @param t_lastspike Point in time of last spike sent.
+             * @param cp Common properties to all synapses.
+             */
+            void send( nest::Event& e,
+                    nest::thread t,
+                    nest::double_t t_lastspike,
+                    const CommonPropertiesType& cp );
+
+            /**
+             * triggers an update of a synaptic weight, propagating the traces
+             * and the learned weight to t_trig and computing the modulation 
+             * @param t Thread
+             * @param modulatory_spikes spikes of the volume transmitter over the interval
+             * @param t_trig update triggering time 
+             * @param cp Common properties to all synapses.
+             */
+            void trigger_update_weight( nest::thread t,
+                    const std::vector< nest::spikecounter >& modulatory_spikes,
+                    nest::double_t t_trig,
+                    const CommonPropertiesType& cp );
+
+            //! Store connection status information in dictionary
+            void get_status( DictionaryDatum& d ) const;
+
+            /**
+             * Set connection status.
+             *
+             * @param d Dictionary with new parameter values
+             * @param cm ConnectorModel is passed along to validate new delay values
+             */
+            void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm );
+
+            //! Allows efficient initialization on contstruction
+            void  set_weight( nest::double_t w )
+            {
+                weight_ = w;
+            }
+
+        private:
+
+            //! Integrate dw/dt = c*(n - b) over minus_dt < 0 ms from c0 and n0, and bound the weight
+            void update_weight_( nest::double_t c0, 
+                    nest::double_t n0, 
+                    nest::double_t minus_dt, 
+                    const CommonPropertiesType& cp )
+            {
+                const nest::double_t taus = ( cp.tau_c_ + cp.tau_n_ )/( cp.tau_c_*cp.tau_n_ );
+                weight_ = weight_ - c0*( n0/taus*numerics::expm1( taus*minus_dt ) 
+                        - cp.b_*cp.tau_c_*numerics::expm1( minus_dt/cp.tau_c_ ) );
+                weight_ = std::min( std::max( weight_, cp.Wmin_ ), cp.Wmax_ );
+            }
+
+            //! Process the dopamine spikes in (t0, t1], propagating weight, c and n
+            void process_dopa_spikes_( const std::vector< nest::spikecounter >& dopa_spikes,
+                    nest::double_t t0,
+                    nest::double_t t1,
+                    const CommonPropertiesType& cp );
+
+            //! Propagate the traces up to t_end, facilitating at each postsynaptic spike 
+            void facilitate_until_( nest::thread t,
+                    const std::vector< nest::spikecounter >& dopa_spikes,
+                    nest::double_t t_end,
+                    nest::double_t& t0,
+                    const CommonPropertiesType& cp );
+    };
+
+    template < typename targetidentifierT, typename modulationT >
+        void ModulatoryStdpConnection< targetidentifierT, modulationT >::process_dopa_spikes_( 
+                const std::vector< nest::spikecounter >& dopa_spikes,
+                nest::double_t t0,
+                nest::double_t t1,
+                const CommonPropertiesType& cp )
+        {
+            // the first spike of the buffer is the last one of the previous interval 
+            if ( dopa_spikes.size() > dopa_spikes_idx_ + 1 
+                    and dopa_spikes[ dopa_spikes_idx_ + 1 ].spike_time_ <= t1 )
+            {
+                // up to the first spike: weight and c are at t0, n at the last spike
+                const nest::spikecounter* last = &dopa_spikes[ dopa_spikes_idx_ ];
+                const nest::spikecounter* next = &dopa_spikes[ dopa_spikes_idx_ + 1 ];
+                const nest::double_t n0 = n_*std::exp( ( last->spike_time_ - t0 )/cp.tau_n_ );
+                update_weight_( c_, n0, t0 - next->spike_time_, cp );
+                n_ = n0*std::exp( ( t0 - next->spike_time_ )/cp.tau_n_ ) 
+                    + next->multiplicity_/cp.tau_n_;
+                ++dopa_spikes_idx_;
+
+                // from spike to spike: weight and n are at the last spike, c at t0
+                while ( dopa_spikes.size() > dopa_spikes_idx_ + 1 
+                        and dopa_spikes[ dopa_spikes_idx_ + 1 ].spike_time_ <= t1 )
+                {
+                    last = &dopa_spikes[ dopa_spikes_idx_ ];
+                    next = &dopa_spikes[ dopa_spikes_idx_ + 1 ];
+                    const nest::double_t cd = c_*std::exp( ( t0 - last->spike_time_ )/cp.tau_c_ );
+                    update_weight_( cd, n_, last->spike_time_ - next->spike_time_, cp );
+                    n_ = n_*std::exp( ( last->spike_time_ - next->spike_time_ )/cp.tau_n_ ) 
+                        + next->multiplicity_/cp.tau_n_;
+                    ++dopa_spikes_idx_;
+                }
+
+                // from the last spike up to t1
+                last = &dopa_spikes[ dopa_spikes_idx_ ];
+                const nest::double_t cd = c_*std::exp( ( t0 - last->spike_time_ )/cp.tau_c_ );
+                update_weight_( cd, n_, last->spike_time_ - t1, cp );
+            }
+            else
+            {
+                // no dopamine spikes in (t0, t1]
+                const nest::double_t n0 = n_*std::exp( 
+                        ( dopa_spikes[ dopa_spikes_idx_ ].spike_time_ - t0 )/cp.tau_n_ );
+                update_weight_( c_, n0, t0 - t1, cp );
+            }
+
+            c_ = c_*std::exp( ( t0 - t1 )/cp.tau_c_ );
+        }
+
+    template < typename targetidentifierT, typename modulationT >
+        void ModulatoryStdpConnection< targetidentifierT, modulationT >::facilitate_until_( 
+                nest::thread t,
+                const std::vector< nest::spikecounter >& dopa_spikes,
+                nest::double_t t_end,
+                nest::double_t& t0,
+                const CommonPropertiesType& cp )
+        {
+            // purely dendritic delay
+            const nest::double_t dendritic_delay = ConnectionBase::get_delay();
+
+            std::deque< nest::histentry >::iterator start;
+            std::deque< nest::histentry >::iterator finish;
+            ConnectionBase::get_target( t )->get_history( t_last_update_ - dendritic_delay, 
+                    t_end - dendritic_delay, &start, &finish );
+
+            // facilitation due to the postsynaptic spikes since the last update
+            t0 = t_last_update_;
+            while ( start != finish )
+            {
+                process_dopa_spikes_( dopa_spikes, t0, start->t_ + dendritic_delay, cp );
+                t0 = start->t_ + dendritic_delay;
+                c_ += cp.A_plus_*Kplus_*std::exp( ( t_last_update_ - t0 )/cp.tau_plus_ );
+                ++start;
+            }
+        }
+
+    template < typename targetidentifierT, typename modulationT >
+        inline void ModulatoryStdpConnection< targetidentifierT, modulationT >::send( nest::Event& e,
+                nest::thread t,
+                nest::double_t,
+                const CommonPropertiesType& cp )
+        {
+            const nest::double_t t_spike = e.get_stamp().get_ms();
+            const std::vector< nest::spikecounter >& dopa_spikes = cp.vt_->deliver_spikes();
+            nest::Node* target = ConnectionBase::get_target( t );
+
+            // facilitation up to the spike, then depression due to the spike 
+            nest::double_t t0;
+            facilitate_until_( t, dopa_spikes, t_spike, t0, cp );
+            process_dopa_spikes_( dopa_spikes, t0, t_spike, cp );
+            c_ -= cp.A_minus_*target->get_K_value( t_spike - ConnectionBase::get_delay() );
+
+            Kplus_ = Kplus_*std::exp( ( t_last_update_ - t_spike )/cp.tau_plus_ ) + 1.0;
+            t_last_update_ = t_spike;
+
+            const nest::double_t weight = cp.clamp( 
+                    weight_*modulationT::compute_modulation( cp.get_last_modulation( t ) ), weight_ );
+
+            // silenced synapses keep learning but do not touch their target
+            if ( cp.is_silenced( weight ) )
+                return;
+
+            if ( cp.counters_ != 0 )
+                cp.count_spike( t );
+
+            e.set_receiver( *target );
+            e.set_weight( weight );
+            e.set_delay( ConnectionBase::get_delay_steps() );
+            e.set_rport( ConnectionBase::get_rport() );
+            e(); // this sends the event
+        }
+
+    template < typename targetidentifierT, typename modulationT >
+        inline void ModulatoryStdpConnection< targetidentifierT, modulationT >::trigger_update_weight( 
+                nest::thread t,
+                const std::vector< nest::spikecounter >& modulatory_spikes,
+                const nest::double_t t_trig,
+                const CommonPropertiesType& cp )
+        {
+            // propagate weight, c, n and Kplus to t_trig, without spikes at t_trig
+            nest::double_t t0;
+            facilitate_until_( t, modulatory_spikes, t_trig, t0, cp );
+            process_dopa_spikes_( modulatory_spikes, t0, t_trig, cp );
+            n_ = n_*std::exp( ( modulatory_spikes[ dopa_spikes_idx_ ].spike_time_ - t_trig )/cp.tau_n_ );
+            Kplus_ = Kplus_*std::exp( ( t_last_update_ - t_trig )/cp.tau_plus_ );
+            t_last_update_ = t_trig;
+
+            // the next interval starts with a spike at t_trig
+            dopa_spikes_idx_ = 0;
+
+            // the modulation is computed once per thread and trigger, 
+            // and applied to the learned weight at each spike 
+            bool changed;
+            const nest::double_t modulation = cp.get_modulation( t, modulatory_spikes, 
+                    t_trig, deliver_interval, changed );
+
+            if ( cp.is_recording( t ) )
+                cp.record( t, this->get_syn_id(), modulatory_spikes, t_trig, 
+                        modulationT::compute_modulation( modulation ) );
+
+            if ( cp.counters_ != 0 )
+                cp.count_synapses( t, 1, 1 );
+        }
+
+    template < typename targetidentifierT, typename modulationT >
+        void ModulatoryStdpConnection< targetidentifierT, modulationT >::get_status( DictionaryDatum& d ) const
+        {
+            ConnectionBase::get_status( d );
+            def< nest::double_t >( d, nest::names::weight, weight_ );
+            def< nest::long_t >( d, "deliver_interval", deliver_interval );
+            def< nest::double_t >( d, "c", c_ );
+            def< nest::double_t >( d, "n", n_ );
+            modulationT::get_status( d );
+            def< nest::long_t >( d, nest::names::size_of, sizeof( *this ) );
+        }
+
+    template < typename targetidentifierT, typename modulationT >
+        void ModulatoryStdpConnection< targetidentifierT, modulationT >::set_status( const DictionaryDatum& d,
+                nest::ConnectorModel& cm )
+        {
+            nest::long_t interval = deliver_interval;
+            if ( updateValue< nest::long_t >( d, "deliver_interval", interval ) and interval < 1 )
+                throw nest::BadProperty( "deliver_interval must be a positive number of min delays." );
+
+            ConnectionBase::set_status( d, cm );
+            updateValue< nest::double_t >( d, nest::names::weight, weight_ );
+            deliver_interval = interval;
+            modulationT::set_status( d );
+        }
+
+    /*
+    *  Dopamine gated STDP fused with the modulation laws of the modulatory, 
+    *  d1, d2 and d2_div synapses
+    */
+    template < typename targetidentifierT >
+        using StdpModulatoryConnection = ModulatoryStdpConnection< targetidentifierT, IdentityModulation<> >;
+
+    template < typename targetidentifierT >
+        using StdpD1Connection = ModulatoryStdpConnection< targetidentifierT, D1Modulation<> >;
+    
+    template < typename targetidentifierT >
+        using StdpD2Connection = ModulatoryStdpConnection< targetidentifierT, D2Modulation<> >;
+    
+    template < typename targetidentifierT >
+        using StdpD2DivConnection = ModulatoryStdpConnection< targetidentifierT, D2DivModulation<> >;
+
+} // namespace nest
+
+#endif // MODULATORY_STDP_CONNECTION
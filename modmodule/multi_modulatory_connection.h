@@ -0,0 +1,536 @@
+/*  
+ *  
+ *   MIT License
+ *   
+ *   Copyright (c) 2016 Francesco Mannella and Daniele Caligiore
+ *   
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+ *   
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *   
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *  
+ */
+
+/*
+ *  The class MultiModulatoryConnection implements modulatory synapses driven by 
+ *  several volume transmitters at once (e.g. dopamine and acetylcholine), so that
+ *  a single synapse and a single event per spike replace one parallel connection
+ *  per modulator.
+ *
+ *  Each channel has its own volume transmitter, max_modulation and deliver 
+ *  interval, set on the model, and its own modulation law parameters, set on
+ *  each synapse. At each trigger of a channel the weight becomes
+ *
+ *      weight = weight_baseline * f_0(m_0) * f_1(m_1) * ...    (combination "product")
+ *      weight = weight_baseline * ( f_0(m_0) + f_1(m_1) + ... ) (combination "sum")
+ *
+ *  where m_k is the last modulation of channel k (0 before its first trigger).
+ *
+ *  Parameters (common to all synapses):
+ *      vts => gids of the volume transmitters, one per channel
+ *      max_modulations => max amount of spikes of each channel
+ *      deliver_intervals => deliver interval of each volume transmitter
+ *      modulation_delays => triggers by which each channel lags its spikes
+ *      combination => "product" (default) or "sum"
+ *      lazy_weight, clamp_weight, silence_threshold => as in the single 
+ *          channel models, the same for all the channels
+ *
+ *  Each channel needs its own volume transmitter.
+ *
+ *  Parameters (of each synapse):
+ *      weight_baseline =>  the baseline value which has to be multiplied times the *modulation* 
+ *      alphas => amplitude of the modulation of each channel (d1, d2 and d2_div laws only)
+ */
+
+#ifndef MULTI_MODULATORY_CONNECTION
+#define MULTI_MODULATORY_CONNECTION
+
+#include "connection.h"
+#include "modulatory_connection.h"
+#include "da_connection.h"
+#include <vector>
+
+namespace mynest
+{
+
+    /**
+     * Class containing the common properties of the synapses driven by N 
+     * volume transmitters. Each channel keeps its modulation in a 
+     * ModulatoryCommonProperties of its own, so that spike sums are 
+     * shared with the other models bound to the same volume transmitter.
+     */
+    template < size_t N >
+        class MultiModulatoryCommonProperties : public nest::CommonSynapseProperties
+    {
+        public:
+
+            /**
+             * Compared by the connectors with the gid of the volume transmitter 
+             * that triggers, so that the synapses are triggered by each of 
+             * their channels.
+             */
+            class VtGids
+            {
+                public:
+                    explicit VtGids( const MultiModulatoryCommonProperties& cp )
+                        : cp_( cp )
+                    {
+                    }
+
+                    bool operator==( nest::long_t vt_gid ) const
+                    {
+                        for ( size_t c = 0; c < N; ++c )
+                            if ( cp_.channels_[ c ].get_vt_gid() == vt_gid )
+                                return true;
+                        return false;
+                    }
+
+                    friend bool operator==( nest::long_t vt_gid, const VtGids& gids )
+                    {
+                        return gids == vt_gid;
+                    }
+
+                private:
+                    const MultiModulatoryCommonProperties& cp_;
+            };
+
+            MultiModulatoryCommonProperties()
+                : nest::CommonSynapseProperties()
+                  ,product_( true )
+            {
+                for ( size_t c = 0; c < N; ++c )
+                    deliver_intervals_[ c ] = 100;
+            }
+
+            void get_status( DictionaryDatum& d ) const;
+
+            void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm );
+
+            nest::Node* get_node()
+            {
+                return channels_[ 0 ].get_node();
+            }
+
+            VtGids get_vt_gid() const
+            {
+                return VtGids( *this );
+            }
+
+            /**
+             * Return the channel whose volume transmitter delivered 
+             * modulatory_spikes, N if none did.
+             */
+            size_t get_channel( const std::vector< nest::spikecounter >& modulatory_spikes ) const
+            {
+                // each volume transmitter or signal delivers its own buffer of spikes 
+                for ( size_t c = 0; c < N; ++c )
+                    if ( ( channels_[ c ].vt_ != 0 
+                                and &channels_[ c ].vt_->deliver_spikes() == &modulatory_spikes )
+                            or ( channels_[ c ].signal_ != 0 
+                                and &channels_[ c ].signal_->deliver_spikes() == &modulatory_spikes ) )
+                        return c;
+                return N;
+            }
+
+            //! See ModulatoryCommonProperties::clamp(), the channels share clamp_weight
+            nest::double_t clamp( nest::double_t weight, nest::double_t weight_baseline ) const
+            {
+                return channels_[ 0 ].clamp( weight, weight_baseline );
+            }
+
+            //! See ModulatoryCommonProperties::is_silenced(), the channels share silence_threshold
+            bool is_silenced( nest::double_t weight ) const
+            {
+                return channels_[ 0 ].is_silenced( weight );
+            }
+
+            //! True if the weights are computed on the next spike, see lazy_weight
+            bool lazy_weight() const
+            {
+                return channels_[ 0 ].lazy_weight_;
+            }
+
+            //! Force all the synapses to update their weight at the next trigger of each channel
+            void invalidate() const
+            {
+                for ( size_t c = 0; c < N; ++c )
+                    channels_[ c ].invalidate();
+            }
+
+            ModulatoryCommonProperties channels_[ N ]; //!< modulation of each channel
+            nest::long_t deliver_intervals_[ N ]; //!< deliver interval of each channel
+            bool product_; //!< combine the channels by product, otherwise by sum
+    };
+
+    template < size_t N >
+        void MultiModulatoryCommonProperties< N >::get_status( DictionaryDatum& d ) const
+        {
+            nest::CommonSynapseProperties::get_status( d );
+
+            std::vector< nest::long_t > vts( N );
+            std::vector< nest::long_t > max_modulations( N );
+            std::vector< nest::long_t > deliver_intervals( N );
+            std::vector< nest::long_t > modulation_delays( N );
+            for ( size_t c = 0; c < N; ++c )
+            {
+                vts[ c ] = channels_[ c ].get_vt_gid();
+                max_modulations[ c ] = channels_[ c ].max_modulation_;
+                deliver_intervals[ c ] = deliver_intervals_[ c ];
+                modulation_delays[ c ] = channels_[ c ].modulation_delay_;
+            }
+
+            def< std::vector< nest::long_t > >( d, "vts", vts );
+            def< std::vector< nest::long_t > >( d, "max_modulations", max_modulations );
+            def< std::vector< nest::long_t > >( d, "deliver_intervals", deliver_intervals );
+            def< std::vector< nest::long_t > >( d, "modulation_delays", modulation_delays );
+            def< std::string >( d, "combination", product_ ? "product" : "sum" );
+            def< bool >( d, "lazy_weight", channels_[ 0 ].lazy_weight_ );
+            def< bool >( d, "clamp_weight", channels_[ 0 ].clamp_weight_ );
+            def< nest::double_t >( d, "silence_threshold", channels_[ 0 ].silence_threshold_ );
+        }
+
+    template < size_t N >
+        void MultiModulatoryCommonProperties< N >::set_status( const DictionaryDatum& d, 
+                nest::ConnectorModel& cm )
+        {
+            nest::CommonSynapseProperties::set_status( d, cm );
+
+            std::vector< nest::long_t > vts;
+            std::vector< nest::long_t > max_modulations;
+            std::vector< nest::long_t > deliver_intervals;
+            std::vector< nest::long_t > modulation_delays;
+            const bool vts_set = updateValue< std::vector< nest::long_t > >( d, "vts", vts );
+            const bool max_set = updateValue< std::vector< nest::long_t > >( d, "max_modulations", max_modulations );
+            const bool intervals_set = updateValue< std::vector< nest::long_t > >( d, "deliver_intervals", deliver_intervals );
+            const bool delays_set = updateValue< std::vector< nest::long_t > >( d, "modulation_delays", modulation_delays );
+
+            if ( ( vts_set and vts.size() != N ) or ( max_set and max_modulations.size() != N ) 
+                    or ( intervals_set and deliver_intervals.size() != N ) 
+                    or ( delays_set and modulation_delays.size() != N ) )
+                throw nest::BadProperty( "vts, max_modulations, deliver_intervals and "
+                        "modulation_delays need one value per channel." );
+
+            // get_channel() tells the channels apart by their volume transmitter
+            if ( vts_set )
+                for ( size_t c = 1; c < N; ++c )
+                    for ( size_t k = 0; k < c; ++k )
+                        if ( vts[ c ] == vts[ k ] )
+                            throw nest::BadProperty( "Each channel needs its own volume transmitter." );
+
+            bool lazy_weight;
+            bool clamp_weight;
+            nest::double_t silence_threshold;
+            const bool lazy_set = updateValue< bool >( d, "lazy_weight", lazy_weight );
+            const bool clamp_set = updateValue< bool >( d, "clamp_weight", clamp_weight );
+            const bool silence_set = updateValue< nest::double_t >( d, "silence_threshold", silence_threshold );
+
+            std::string combination;
+            if ( updateValue< std::string >( d, "combination", combination ) )
+            {
+                if ( combination != "product" and combination != "sum" )
+                    throw nest::BadProperty( "combination must be \"product\" or \"sum\"." );
+                product_ = ( combination == "product" );
+            }
+
+            // each channel is set as a single modulatory model
+            for ( size_t c = 0; c < N; ++c )
+            {
+                DictionaryDatum channel( new Dictionary );
+                if ( vts_set )
+                    def< nest::long_t >( channel, "vt", vts[ c ] );
+                if ( max_set )
+                    def< nest::long_t >( channel, "max_modulation", max_modulations[ c ] );
+                if ( delays_set )
+                    def< nest::long_t >( channel, "modulation_delay", modulation_delays[ c ] );
+                if ( lazy_set )
+                    def< bool >( channel, "lazy_weight", lazy_weight );
+                if ( clamp_set )
+                    def< bool >( channel, "clamp_weight", clamp_weight );
+                if ( silence_set )
+                    def< nest::double_t >( channel, "silence_threshold", silence_threshold );
+                if ( intervals_set )
+                    deliver_intervals_[ c ] = deliver_intervals[ c ];
+                channels_[ c ].set_status( channel, cm );
+            }
+        }
+
+    /**
+     * Multi modulatory connection
+     * N moduatory populations change the 
+     * strength of the weights together
+     *
+     * @tparam modulationT policy giving the modulation law of every channel, see IdentityModulation 
+     * @tparam N number of channels
+     */
+    template < typename targetidentifierT, 
+             typename modulationT = IdentityModulation<>, 
+             size_t N = 2 >
+        class MultiModulatoryConnection : public nest::Connection< targetidentifierT >
+    {
+        public:
+            //! Type used to store weights
+            typedef typename modulationT::value_type value_type;
+
+            //! Type to use for representing common synapse properties
+            typedef MultiModulatoryCommonProperties< N > CommonPropertiesType;
+
+            //! Shortcut for base class
+            typedef nest::Connection< targetidentifierT > ConnectionBase;
+
+        private:
+            value_type weight_baseline; //!< Initial synaptic weight
+            value_type weight_; //!< Synaptic weight
+            modulationT laws_[ N ]; //!< modulation law of each channel
+            unsigned int epochs_[ N ]; //!< modulation epoch of each channel weight_ was computed at, see lazy_weight
+
+            /**
+             * The weight given by the modulation of each channel, 
+             * combined as set in cp.
+             */
+            nest::double_t compute_weight( const nest::double_t* modulations,
+                    const CommonPropertiesType& cp ) const
+            {
+                nest::double_t factor = cp.product_ ? 1.0 : 0.0;
+                for ( size_t c = 0; c < N; ++c )
+                {
+                    if ( cp.product_ )
+                        factor *= laws_[ c ].compute_modulation( modulations[ c ] );
+                    else
+                        factor += laws_[ c ].compute_modulation( modulations[ c ] );
+                }
+                return cp.clamp( weight_baseline*factor, weight_baseline );
+            }
+
+        public:
+
+            /**
+             * Default Constructor.
+             * Sets default values for all parameters. Needed by GenericConnectorModel.
+             */
+            MultiModulatoryConnection() 
+                : ConnectionBase()
+                  ,weight_baseline(1.0)
+                  ,weight_(1.0)
+            {
+                for ( size_t c = 0; c < N; ++c )
+                    epochs_[ c ] = 0;
+            }
+
+            /**
+             * Helper class defining which types of events can be transmitted.
+             * See ModulatoryConnection::ConnTestDummyNode.
+             */
+            class ConnTestDummyNode 
+                : public nest::ConnTestDummyNodeBase 
+            {
+                public:
+                    using nest::ConnTestDummyNodeBase::handles_test_event;
+                    nest::port handles_test_event( nest::SpikeEvent&, nest::rport )
+                    {
+                        return nest::invalid_port_;
+                    }
+            };
+
+            /**
+             * Check that requested connection can be created.
+             * See ModulatoryConnection::check_connection().
+             */
+            void check_connection( nest::Node& s,
+                    nest::Node& t,
+                    nest::rport receptor_type,
+                    nest::double_t,
+                    const CommonPropertiesType& cp )
+            {
+                ConnTestDummyNode dummy_target;
+                ConnectionBase::check_connection_( dummy_target, s, t, receptor_type );
+
+                // the new synapse gets its modulated weight at the next trigger
+                cp.invalidate();
+            }
+
+            /**
+             * Send an event to the receiver of this connection.
+             * @param e The event to send
+             * @param t Thread
+             * @param t_lastspike Point in time of last spike sent.
+             * @param cp Common properties to all synapses.
+             */
+            void send( nest::Event& e,
+                    nest::thread t,
+                    nest::double_t,
+                    const CommonPropertiesType& cp )
+            {
+                // with lazy_weight the weight is updated here, 
+                // only if a channel changed since the last spike
+                if ( cp.lazy_weight() )
+                {
+                    bool stale = false;
+                    nest::double_t modulations[ N ];
+                    for ( size_t c = 0; c < N; ++c )
+                    {
+                        if ( cp.channels_[ c ].get_lazy_modulation( t, epochs_[ c ], 
+                                    cp.deliver_intervals_[ c ], modulations[ c ] ) )
+                            stale = true;
+                        else
+                            modulations[ c ] = cp.channels_[ c ].get_last_modulation( t );
+                    }
+                    if ( stale )
+                        weight_ = compute_weight( modulations, cp );
+                }
+
+                // silenced synapses do not touch their target
+                if ( cp.is_silenced( weight_ ) )
+                    return;
+
+                e.set_weight( weight_ );
+                e.set_delay( ConnectionBase::get_delay_steps() );
+                e.set_receiver( *ConnectionBase::get_target( t ) );
+                e.set_rport( ConnectionBase::get_rport() );
+                e(); // this sends the event
+            }
+
+            /**
+             * triggers an update of a synaptic weight by one of the channels,
+             * identified by the spikes it delivers
+             * @param t Thread
+             * @param modulatory_spikes counter of modulatory spikes
+             * @param t_trig update triggering time 
+             * @param cp Common properties to all synapses.
+             */
+            void trigger_update_weight( nest::thread t,
+                    const std::vector< nest::spikecounter >& modulatory_spikes,
+                    nest::double_t t_trig,
+                    const CommonPropertiesType& cp );
+
+            //! Store connection status information in dictionary
+            void get_status( DictionaryDatum& d ) const;
+
+            /**
+             * Set connection status.
+             *
+             * @param d Dictionary with new parameter values
+             * @param cm ConnectorModel is passed along to validate new delay values
+             */
+            void set_status( const DictionaryDatum& d, nest::ConnectorModel& cm );
+
+            //! Allows efficient initialization on contstruction
+            void  set_weight( nest::double_t w )
+            {
+                weight_ = w;
+            }
+    };
+
+    template < typename targetidentifierT, typename modulationT, size_t N >
+        inline void MultiModulatoryConnection< targetidentifierT, modulationT, N >::trigger_update_weight( 
+                nest::thread t,
+                const std::vector< nest::spikecounter >& modulatory_spikes,
+                const nest::double_t t_trig,
+                const CommonPropertiesType& cp )
+        {
+            const size_t channel = cp.get_channel( modulatory_spikes );
+            if ( channel == N )
+                return;
+
+            const ModulatoryCommonProperties& triggered = cp.channels_[ channel ];
+            bool changed;
+            const nest::double_t modulation = triggered.get_modulation( t, modulatory_spikes, 
+                    t_trig, cp.deliver_intervals_[ channel ], changed );
+
+            if ( triggered.is_recording( t ) )
+                triggered.record( t, this->get_syn_id(), modulatory_spikes, t_trig, 
+                        laws_[ channel ].compute_modulation( modulation ) );
+
+            // nothing to rewrite if the weight would stay the same, 
+            // or if it will be computed on the next spike
+            if ( not changed or cp.lazy_weight() )
+                return;
+
+            // the other channels keep the modulation of their last trigger 
+            nest::double_t modulations[ N ];
+            for ( size_t c = 0; c < N; ++c )
+                modulations[ c ] = ( c == channel ) ? modulation 
+                    : cp.channels_[ c ].get_last_modulation( t );
+
+            weight_ = compute_weight( modulations, cp );
+        }
+
+    template < typename targetidentifierT, typename modulationT, size_t N >
+        void MultiModulatoryConnection< targetidentifierT, modulationT, N >::get_status( DictionaryDatum& d ) const
+        {
+            ConnectionBase::get_status( d );
+            def< nest::double_t >( d, nest::names::weight, weight_ );
+            def< nest::double_t >( d, "weight_baseline", weight_baseline );
+
+            // the laws store their parameters under their own names 
+            std::vector< nest::double_t > alphas;
+            for ( size_t c = 0; c < N; ++c )
+            {
+                DictionaryDatum law( new Dictionary );
+                laws_[ c ].get_status( law );
+                if ( law->known( "alpha" ) )
+                    alphas.push_back( getValue< nest::double_t >( law, "alpha" ) );
+            }
+            if ( not alphas.empty() )
+                def< std::vector< nest::double_t > >( d, "alphas", alphas );
+
+            def< nest::long_t >( d, nest::names::size_of, sizeof( *this ) );
+        }
+
+    template < typename targetidentifierT, typename modulationT, size_t N >
+        void MultiModulatoryConnection< targetidentifierT, modulationT, N >::set_status( const DictionaryDatum& d,
+                nest::ConnectorModel& cm )
+        {
+            ConnectionBase::set_status( d, cm );
+            updateValue< nest::double_t >( d, nest::names::weight, weight_ );
+            updateValue< nest::double_t >( d, "weight_baseline", weight_baseline );
+
+            std::vector< nest::double_t > alphas;
+            if ( updateValue< std::vector< nest::double_t > >( d, "alphas", alphas ) )
+            {
+                if ( alphas.size() != N )
+                    throw nest::BadProperty( "alphas needs one value per channel." );
+                for ( size_t c = 0; c < N; ++c )
+                {
+                    DictionaryDatum law( new Dictionary );
+                    def< nest::double_t >( law, "alpha", alphas[ c ] );
+                    laws_[ c ].set_status( law );
+                }
+            }
+
+            // the changed synapse must not be skipped at the next trigger
+            static_cast< const CommonPropertiesType& >( 
+                    cm.get_common_properties() ).invalidate();
+        }
+
+    /*
+    *  Synapses modulated by two volume transmitters, with the 
+    *  laws of the modulatory, d1, d2 and d2_div synapses
+    */
+    template < typename targetidentifierT >
+        using MultiModulatoryConnection2 = MultiModulatoryConnection< targetidentifierT >;
+
+    template < typename targetidentifierT >
+        using MultiD1Connection = MultiModulatoryConnection< targetidentifierT, D1Modulation<> >;
+    
+    template < typename targetidentifierT >
+        using MultiD2Connection = MultiModulatoryConnection< targetidentifierT, D2Modulation<> >;
+    
+    template < typename targetidentifierT >
+        using MultiD2DivConnection = MultiModulatoryConnection< targetidentifierT, D2DivModulation<> >;
+
+} // namespace nest
+
+#endif // MULTI_MODULATORY_CONNECTION
@@ -0,0 +1,165 @@
+#----------------------------------------------------------
+# benchmark.py
+#
+# Thread and size scaling of the modulatory synapses, built
+# on the network of example.py. Every combination of the
+# swept parameters is simulated once per synapse model,
+# static_synapse included as the baseline, and one CSV row
+# is written for each run:
+#
+#   python benchmark.py --neurons 100 1000 --threads 1 2 4 \
+#       --output scaling.csv
+#
+# trigger_overhead is the Simulate time of the run minus the
+# one of static_synapse with the same parameters.
+#----------------------------------------------------------
+
+import argparse
+import csv
+import itertools
+import time
+
+import nest
+
+MODELS = ["static_synapse", "modulatory_synapse", "d1_synapse", 
+        "d2_synapse", "d2_div_synapse"]
+
+FIELDS = ["model", "neurons", "density", "n_vt", "deliver_interval", 
+        "threads", "synapses", "build_time", "simulate_time", 
+        "trigger_overhead", "size_of"]
+
+######################################################################################################
+######################################################################################################
+######################################################################################################
+
+def parse_args() :
+    parser = argparse.ArgumentParser(description="Scaling benchmark of modmodule")
+    parser.add_argument("--neurons", type=int, nargs="+", default=[100, 1000],
+            help="neurons in the pre and in the post population")
+    parser.add_argument("--density", type=float, nargs="+", default=[0.1],
+            help="connection probability between pre and post neurons")
+    parser.add_argument("--n-vt", type=int, nargs="+", default=[1],
+            help="volume transmitters, each modulating a part of the post population")
+    parser.add_argument("--deliver-interval", type=int, nargs="+", default=[10, 100],
+            help="deliver interval of the volume transmitters (steps)")
+    parser.add_argument("--threads", type=int, nargs="+", default=[1, 2, 4],
+            help="local_num_threads")
+    parser.add_argument("--models", nargs="+", default=MODELS,
+            help="synapse models, static_synapse is the baseline")
+    parser.add_argument("--mod-neurons", type=int, default=10,
+            help="modulatory neurons per volume transmitter")
+    parser.add_argument("--stime", type=float, default=1000.0,
+            help="simulated time (ms)")
+    parser.add_argument("--dt", type=float, default=0.1,
+            help="resolution (ms)")
+    parser.add_argument("--output", default="benchmark.csv",
+            help="CSV file the results are written to")
+    return parser.parse_args()
+
+######################################################################################################
+######################################################################################################
+######################################################################################################
+
+def build(model, neurons, density, n_vt, deliver_interval, threads, args) :
+    """ Build the network of example.py at the given size, return the 
+    modulated connections. """
+
+    nest.ResetKernel()
+    nest.SetKernelStatus({
+        "local_num_threads" : threads, 
+        "resolution" : args.dt})
+    
+    # create a poisson generator
+    poisson = nest.Create("poisson_generator", 1, {"rate" : 10000.0})
+
+    # create the pre and post populations
+    pre = nest.Create("iaf_psc_exp", neurons)
+    post = nest.Create("iaf_psc_exp", neurons)
+    nest.Connect(poisson, pre)
+
+    # each volume transmitter modulates an equal part of the post population
+    conns = []
+    part = max(1, neurons//n_vt)
+    for v in range(n_vt) :
+        targets = post[v*part:(v + 1)*part] if v < n_vt - 1 else post[v*part:]
+        if len(targets) == 0 :
+            continue
+
+        # the baseline simulates the modulatory populations too
+        mod = nest.Create("iaf_psc_exp", args.mod_neurons)
+        vol = nest.Create("volume_transmitter")
+        nest.SetStatus(vol, "deliver_interval", deliver_interval)
+        nest.Connect(poisson, mod)
+        nest.Connect(mod, vol)
+
+        syn_model = model
+        if model != "static_synapse" :
+            # the synapses must be told the interval of their volume transmitter
+            syn_model = "%s_vt%d" % (model, v)
+            nest.CopyModel(model, syn_model, {"vt" : vol[0], 
+                "max_modulation" : args.mod_neurons,
+                "deliver_interval" : deliver_interval})
+            
+        nest.Connect(pre, targets, 
+                conn_spec={"rule" : "pairwise_bernoulli", "p" : density}, 
+                syn_spec={"model" : syn_model})
+        conns += list(nest.GetConnections(pre, targets, synapse_model=syn_model))
+
+    return conns
+
+######################################################################################################
+######################################################################################################
+######################################################################################################
+
+def main() :
+    args = parse_args()
+
+    # install the module 
+    try :
+        nest.Install("modmodule")
+    except nest.NESTError :
+        pass
+
+    # static_synapse first, as the baseline of the other models
+    models = sorted(args.models, key=lambda m : m != "static_synapse")
+
+    with open(args.output, "w") as output :
+        writer = csv.DictWriter(output, fieldnames=FIELDS)
+        writer.writeheader()
+
+        for neurons, density, n_vt, deliver_interval, threads in itertools.product(
+                args.neurons, args.density, args.n_vt, args.deliver_interval, args.threads) :
+
+            baseline = None
+            for model in models :
+                start = time.time()
+                conns = build(model, neurons, density, n_vt, deliver_interval, threads, args)
+                build_time = time.time() - start
+
+                start = time.time()
+                nest.Simulate(args.stime)
+                simulate_time = time.time() - start
+
+                if model == "static_synapse" :
+                    baseline = simulate_time
+
+                row = {
+                        "model" : model,
+                        "neurons" : neurons,
+                        "density" : density,
+                        "n_vt" : n_vt,
+                        "deliver_interval" : deliver_interval,
+                        "threads" : threads,
+                        "synapses" : len(conns),
+                        "build_time" : build_time,
+                        "simulate_time" : simulate_time,
+                        "trigger_overhead" : "" if baseline is None else simulate_time - baseline,
+                        "size_of" : nest.GetStatus(conns[:1], "size_of")[0] if conns else "" }
+                writer.writerow(row)
+                output.flush()
+
+                print("%(model)s neurons=%(neurons)d threads=%(threads)d "
+                        "synapses=%(synapses)d simulate=%(simulate_time).3fs" % row)
+
+if __name__ == "__main__" :
+    main()
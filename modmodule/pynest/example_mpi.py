@@ -0,0 +1,73 @@
+#----------------------------------------------------------
+# example_mpi.py
+#
+# Compares a volume transmitter with a modulation_reducer,
+# run with:
+#
+#     mpirun -np 4 python example_mpi.py
+#
+# Each process prints the mean weight of the synapses it holds
+# for each of the two sources, and checks that they are the same.
+#----------------------------------------------------------
+
+import numpy as np
+
+import nest
+
+dt = 0.1
+THREADS = 2
+STIME = 1000.0
+
+nest.SetKernelStatus({
+    "local_num_threads" : THREADS, 
+    "resolution" : dt})
+
+# install the module
+nest.Install("modmodule")
+
+NEURONS_PRE_N = 50
+NEURONS_POST_N = 50
+NEURONS_MOD_N = 200
+
+POISSON_GENERATOR = nest.Create("poisson_generator", params={'rate': 10000.0})
+
+NEURONS_PRE = nest.Create("iaf_psc_exp", NEURONS_PRE_N)
+NEURONS_POST = nest.Create("iaf_psc_exp", NEURONS_POST_N)
+NEURONS_MOD = nest.Create("iaf_psc_exp", NEURONS_MOD_N)
+
+# the volume transmitter receives every modulatory spike on every process;
+# the reducer is only connected to the modulatory neurons of its own 
+# process and sums their counts with the other processes once per interval
+VOL = nest.Create("volume_transmitter")
+nest.SetStatus(VOL, "deliver_interval", 10)
+RED = nest.Create("modulation_reducer")
+nest.SetStatus(RED, "deliver_interval", 10)
+
+nest.CopyModel("d1_synapse", "vt_synapse", { "vt": VOL[0], 
+            "alpha": 3.0, "max_modulation": NEURONS_MOD_N } )
+nest.CopyModel("d1_synapse", "reducer_synapse", { "vt": RED[0], 
+            "alpha": 3.0, "max_modulation": NEURONS_MOD_N } )
+
+conn_dict = {"rule": "all_to_all"}
+nest.Connect(NEURONS_PRE, NEURONS_POST, conn_spec=conn_dict, syn_spec={"model": "vt_synapse"})
+nest.Connect(NEURONS_PRE, NEURONS_POST, conn_spec=conn_dict, syn_spec={"model": "reducer_synapse"})
+
+nest.Connect(POISSON_GENERATOR, NEURONS_MOD)
+nest.Connect(POISSON_GENERATOR, NEURONS_PRE)
+nest.Connect(NEURONS_MOD, VOL)
+nest.Connect(NEURONS_MOD, RED)
+
+nest.Simulate(STIME)
+
+rank = nest.Rank()
+mean_weights = {}
+for model in ["vt_synapse", "reducer_synapse"]:
+    conns = nest.GetConnections(synapse_model=model)
+    weights = np.array(nest.GetStatus(conns, "weight"))
+    mean_weights[model] = weights.mean()
+    print("rank %d %-16s synapses %6d mean weight %f" % (rank, model, len(weights), weights.mean()))
+print("rank %d modulation_reducer local spikes %d global spikes %d" % (
+        rank, nest.GetStatus(RED, "local_spikes")[0], nest.GetStatus(RED, "num_spikes")[0]))
+
+assert np.isclose(mean_weights["vt_synapse"], mean_weights["reducer_synapse"]), \
+        "rank %d: the modulation_reducer and the volume transmitter disagree" % rank
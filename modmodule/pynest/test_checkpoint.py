@@ -0,0 +1,80 @@
+#----------------------------------------------------------
+# test_checkpoint.py
+#
+# Saves the modulatory synapses of a network, loads them in
+# a rebuilt one and checks synapses and model defaults:
+#
+#     python test_checkpoint.py
+#----------------------------------------------------------
+
+import os
+import shutil
+import tempfile
+import unittest
+
+import numpy as np
+
+import nest
+
+nest.Install("modmodule")
+
+DEFAULTS = {"max_modulation": 5, "lazy_weight": True, "tau_modulation": 20.0,
+        "modulation_function": "sigmoid", "sigmoid_threshold": 0.3}
+
+
+class CheckpointTestCase(unittest.TestCase):
+
+    def setUp(self):
+        self.tmpdir = tempfile.mkdtemp()
+        self.filename = os.path.join(self.tmpdir, "network.ckpt")
+
+    def tearDown(self):
+        shutil.rmtree(self.tmpdir)
+
+    def build(self, threads):
+        """ Nodes and copied model, created with the same gids and names each time """
+        nest.ResetKernel()
+        nest.SetKernelStatus({"resolution": 0.1, "local_num_threads": threads})
+        self.vt = nest.Create("volume_transmitter")
+        self.pre = nest.Create("iaf_psc_exp", 4)
+        self.post = nest.Create("iaf_psc_exp", 4)
+        nest.CopyModel("d1_synapse", "ckpt_synapse")
+
+    def synapses(self):
+        conns = nest.GetConnections(synapse_model="ckpt_synapse")
+        status = nest.GetStatus(conns, ["source", "target", "delay",
+            "weight_baseline", "alpha", "weight"])
+        return sorted(status)
+
+    def test_save_and_load(self):
+        self.build(2)
+        nest.SetDefaults("ckpt_synapse", dict(DEFAULTS, vt=self.vt[0]))
+        nest.Connect(self.pre, self.post, conn_spec={"rule": "all_to_all"},
+                syn_spec={"model": "ckpt_synapse", "delay": 2.0})
+        conns = nest.GetConnections(synapse_model="ckpt_synapse")
+        nest.SetStatus(conns, [{"weight_baseline": w, "alpha": a} for w, a in
+            zip(np.random.uniform(0.5, 1.5, len(conns)), np.random.uniform(0, 1, len(conns)))])
+        saved = self.synapses()
+        self.assertEqual(nest.sli_func("SaveModulatorySynapses", self.filename), len(saved))
+
+        # the sections of two threads are loaded by three
+        self.build(3)
+        self.assertEqual(nest.sli_func("LoadModulatorySynapses", self.filename), len(saved))
+        self.assertEqual(len(self.synapses()), len(saved))
+        self.assertTrue(np.allclose(self.synapses(), saved))
+
+        defaults = nest.GetDefaults("ckpt_synapse")
+        self.assertEqual(defaults["vt"], self.vt[0])
+        for key, value in DEFAULTS.items():
+            self.assertEqual(defaults[key], value)
+
+    def test_stdp_refused(self):
+        self.build(1)
+        nest.SetDefaults("stdp_d1_synapse", {"vt": self.vt[0]})
+        nest.Connect(self.pre, self.post, syn_spec={"model": "stdp_d1_synapse"})
+        with self.assertRaises(nest.NESTError):
+            nest.sli_func("SaveModulatorySynapses", self.filename)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,67 @@
+#----------------------------------------------------------
+# test_modulation_field.py
+#
+# Releases the spikes of a modulatory neuron in one cell of a
+# modulation_field and checks the concentration and the
+# weights of the synapses bound to it:
+#
+#     python test_modulation_field.py
+#----------------------------------------------------------
+
+import unittest
+
+import numpy as np
+
+import nest
+
+nest.Install("modmodule")
+
+
+class ModulationFieldTestCase(unittest.TestCase):
+
+    def setUp(self):
+        nest.ResetKernel()
+        nest.SetKernelStatus({"resolution": 0.1, "local_num_threads": 2})
+
+        # one source in cell 2 + 5*2 = 12, no diffusion and almost no decay
+        gen = nest.Create("spike_generator", params={"spike_times": [2.0, 3.0, 4.0]})
+        self.source = nest.Create("parrot_neuron")
+        nest.Connect(gen, self.source)
+        self.field = nest.Create("modulation_field", params={
+            "shape": [5, 5], "cell_size": 1.0, "diffusion": 0.0, "tau_decay": 1e9,
+            "deliver_interval": 10, "sources": list(self.source), "positions": [2.5, 2.5]})
+
+    def test_concentration(self):
+        nest.Connect(self.source, self.field)
+        nest.Simulate(20.0)
+
+        concentration = np.array(nest.GetStatus(self.field, "concentration")[0])
+        self.assertEqual(len(concentration), 25)
+        self.assertAlmostEqual(concentration[12], 3.0, places=6)
+        self.assertTrue(np.allclose(np.delete(concentration, 12), 0.0))
+
+    def test_synapses_read_their_cell(self):
+        nest.Connect(self.source, self.field)
+        nest.SetDefaults("field_modulatory_synapse", {
+            "field": self.field[0], "max_concentration": 3.0})
+        pre = nest.Create("iaf_psc_exp")
+        post = nest.Create("iaf_psc_exp", 2)
+        nest.Connect(pre, post[:1], syn_spec={
+            "model": "field_modulatory_synapse", "weight_baseline": 2.0, "cell": 12})
+        nest.Connect(pre, post[1:], syn_spec={
+            "model": "field_modulatory_synapse", "weight_baseline": 2.0, "cell": 0})
+        nest.Simulate(20.0)
+
+        weight = lambda target: nest.GetStatus(nest.GetConnections(pre, target), "weight")[0]
+        self.assertAlmostEqual(weight(post[:1]), 2.0, places=6)
+        self.assertAlmostEqual(weight(post[1:]), 0.0)
+
+    def test_unknown_source(self):
+        # a neuron without a position can not be connected to the field
+        other = nest.Create("parrot_neuron")
+        with self.assertRaises(nest.NESTError):
+            nest.Connect(other, self.field)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,77 @@
+#----------------------------------------------------------
+# test_modulation_rate.py
+#
+# Drives a modulation_rate with current generators and checks
+# the modulation it passes to the synapses bound to it:
+#
+#     python test_modulation_rate.py
+#----------------------------------------------------------
+
+import unittest
+
+import numpy as np
+
+import nest
+
+nest.Install("modmodule")
+
+
+class ModulationRateTestCase(unittest.TestCase):
+
+    def setUp(self):
+        nest.ResetKernel()
+        nest.SetKernelStatus({"resolution": 0.1, "local_num_threads": 2})
+
+        # triggers every 10 ms, min_delay being 1 ms
+        self.rate = nest.Create("modulation_rate", params={
+            "rate": 0.2, "gain": 0.4, "deliver_interval": 10})
+
+        nest.SetDefaults("modulatory_synapse", {"vt": self.rate[0]})
+        pre = nest.Create("iaf_psc_exp", 2)
+        post = nest.Create("iaf_psc_exp", 2)
+        nest.Connect(pre, post, conn_spec={"rule": "all_to_all"},
+                syn_spec={"model": "modulatory_synapse", "weight_baseline": 2.0})
+        self.conns = nest.GetConnections(synapse_model="modulatory_synapse")
+
+    def weights(self):
+        return np.array(nest.GetStatus(self.conns, "weight"))
+
+    def test_rate_without_input(self):
+        nest.Simulate(50.0)
+        self.assertAlmostEqual(nest.GetStatus(self.rate, "modulation")[0], 0.2)
+        self.assertTrue(np.allclose(self.weights(), 2.0*0.2))
+
+        # the rate can change between two simulations
+        nest.SetStatus(self.rate, {"rate": 0.7})
+        nest.Simulate(50.0)
+        self.assertAlmostEqual(nest.GetStatus(self.rate, "modulation")[0], 0.7)
+        self.assertTrue(np.allclose(self.weights(), 2.0*0.7))
+
+    def test_dc_generator(self):
+        dc = nest.Create("dc_generator", params={"amplitude": 0.5})
+        nest.Connect(dc, self.rate)
+        nest.Simulate(100.0)
+
+        # the current reaches the node after one delay, the last
+        # interval sees it at every step
+        modulation = 0.2 + 0.4*0.5
+        self.assertAlmostEqual(nest.GetStatus(self.rate, "modulation")[0], modulation)
+        self.assertTrue(np.allclose(self.weights(), 2.0*modulation))
+
+    def test_ac_generator(self):
+        # one period per interval: the mean current of an interval is 0
+        ac = nest.Create("ac_generator", params={"amplitude": 0.1, "frequency": 100.0})
+        nest.Connect(ac, self.rate)
+
+        modulations = []
+        for _ in range(10):
+            nest.Simulate(10.0)
+            modulations.append(nest.GetStatus(self.rate, "modulation")[0])
+
+        # the first interval misses the current of the first delay
+        self.assertTrue(np.allclose(modulations[1:], 0.2, atol=1e-6))
+        self.assertTrue(abs(modulations[0] - 0.2) <= 0.4*0.1)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,90 @@
+#----------------------------------------------------------
+# test_modulation_recorder.py
+#
+# Records the modulation of a volume transmitter in memory
+# and to a csv file and checks it against the synapses:
+#
+#     python test_modulation_recorder.py
+#----------------------------------------------------------
+
+import csv
+import os
+import shutil
+import tempfile
+import unittest
+
+import numpy as np
+
+import nest
+
+nest.Install("modmodule")
+
+
+class ModulationRecorderTestCase(unittest.TestCase):
+
+    def setUp(self):
+        nest.ResetKernel()
+        nest.SetKernelStatus({"resolution": 0.1, "local_num_threads": 2})
+        self.tmpdir = tempfile.mkdtemp()
+
+        # the modulatory spikes reach the volume transmitter through a parrot
+        self.spike_times = [2.0, 5.0, 12.0, 13.0, 14.0, 31.0]
+        gen = nest.Create("spike_generator", params={"spike_times": self.spike_times})
+        parrot = nest.Create("parrot_neuron")
+        self.vt = nest.Create("volume_transmitter", params={"deliver_interval": 10})
+        nest.Connect(gen, parrot)
+        nest.Connect(parrot, self.vt)
+
+        nest.SetDefaults("modulatory_synapse", {"vt": self.vt[0], "max_modulation": 4})
+        pre = nest.Create("iaf_psc_exp", 2)
+        post = nest.Create("iaf_psc_exp", 2)
+        nest.Connect(pre, post, conn_spec={"rule": "all_to_all"},
+                syn_spec={"model": "modulatory_synapse", "weight_baseline": 2.0})
+        self.conns = nest.GetConnections(synapse_model="modulatory_synapse")
+
+    def tearDown(self):
+        shutil.rmtree(self.tmpdir)
+
+    def test_memory(self):
+        rec = nest.Create("modulation_recorder", params={
+            "vt": self.vt[0], "record_response": True})
+        nest.Simulate(50.0)
+
+        events = nest.GetStatus(rec, "events")[0]
+        n_events = nest.GetStatus(rec, "n_events")[0]
+        self.assertTrue(n_events > 0)
+        self.assertEqual(len(events["times"]), n_events)
+        self.assertEqual(set(events["models"]), {"modulatory_synapse"})
+        self.assertTrue(np.all(np.diff(events["times"]) >= 0))
+
+        # every trigger sees the spikes of its own interval only
+        num_spikes = dict(zip(events["times"], events["num_spikes"]))
+        self.assertTrue(0 < sum(num_spikes.values()) <= len(self.spike_times))
+
+        # the identity law passes the modulation to the weights unchanged
+        self.assertTrue(np.allclose(events["response"], events["modulation"]))
+        weights = np.array(nest.GetStatus(self.conns, "weight"))
+        self.assertTrue(np.allclose(weights, 2.0*events["modulation"][-1]))
+
+        nest.SetStatus(rec, {"n_events": 0})
+        self.assertEqual(nest.GetStatus(rec, "n_events")[0], 0)
+        self.assertEqual(len(nest.GetStatus(rec, "events")[0]["times"]), 0)
+
+    def test_csv_file(self):
+        filename = os.path.join(self.tmpdir, "modulation.csv")
+        rec = nest.Create("modulation_recorder", params={
+            "vt": self.vt[0], "record_to": "file", "filename": filename})
+        nest.Simulate(50.0)
+
+        with open(filename) as f:
+            rows = list(csv.reader(f))
+        self.assertEqual(rows[0], ["time", "model", "num_spikes", "modulation", "response"])
+        self.assertEqual(len(rows) - 1, nest.GetStatus(rec, "n_events")[0])
+        self.assertTrue(all(row[1] == "modulatory_synapse" for row in rows[1:]))
+
+        # without record_response the response is not a number
+        self.assertTrue(all(np.isnan(float(row[4])) for row in rows[1:]))
+
+
+if __name__ == "__main__":
+    unittest.main()
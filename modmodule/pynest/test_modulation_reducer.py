@@ -0,0 +1,70 @@
+#----------------------------------------------------------
+# test_modulation_reducer.py
+#
+# Drives a volume transmitter and a modulation_reducer with
+# the same modulatory spikes and checks that their synapses
+# get the same weights:
+#
+#     python test_modulation_reducer.py
+#----------------------------------------------------------
+
+import unittest
+
+import numpy as np
+
+import nest
+
+nest.Install("modmodule")
+
+
+class ModulationReducerTestCase(unittest.TestCase):
+
+    def setUp(self):
+        nest.ResetKernel()
+        nest.SetKernelStatus({"resolution": 0.1, "local_num_threads": 2})
+
+        gen = nest.Create("spike_generator", params={
+            "spike_times": [2.0, 5.0, 12.0, 13.0, 14.0, 31.0, 32.0]})
+        parrots = nest.Create("parrot_neuron", 2)
+        nest.Connect(gen, parrots)
+
+        self.vt = nest.Create("volume_transmitter", params={"deliver_interval": 10})
+        self.reducer = nest.Create("modulation_reducer", params={"deliver_interval": 10})
+        nest.Connect(parrots, self.vt)
+        nest.Connect(parrots, self.reducer)
+
+        nest.CopyModel("modulatory_synapse", "vt_synapse",
+                {"vt": self.vt[0], "max_modulation": 4})
+        nest.CopyModel("modulatory_synapse", "reducer_synapse",
+                {"vt": self.reducer[0], "max_modulation": 4})
+
+        pre = nest.Create("iaf_psc_exp", 3)
+        post = nest.Create("iaf_psc_exp", 3)
+        for model in ["vt_synapse", "reducer_synapse"]:
+            nest.Connect(pre, post, conn_spec={"rule": "all_to_all"},
+                    syn_spec={"model": model, "weight_baseline": 2.0})
+
+    def weights(self, model):
+        conns = nest.GetConnections(synapse_model=model)
+        return np.array(nest.GetStatus(conns, "weight"))
+
+    def test_same_weights_as_volume_transmitter(self):
+        for _ in range(5):
+            nest.Simulate(10.0)
+            self.assertTrue(np.allclose(self.weights("vt_synapse"),
+                self.weights("reducer_synapse")))
+
+    def test_counts_by_delivery_interval(self):
+        # the spikes reach the parrots after 1 ms and the reducer after 2 ms,
+        # each interval counts the spikes of both parrots delivered in it
+        for expected in [4, 6, 0, 4]:
+            nest.Simulate(10.0)
+            local_spikes, num_spikes = nest.GetStatus(self.reducer, ["local_spikes", "num_spikes"])[0]
+
+            # one process: the global count is the local one
+            self.assertEqual(local_spikes, num_spikes)
+            self.assertEqual(num_spikes, expected)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,68 @@
+#----------------------------------------------------------
+# test_modulation_replay.py
+#
+# Replays a time series from csv and binary files and checks
+# the modulation it passes to the synapses bound to it:
+#
+#     python test_modulation_replay.py
+#----------------------------------------------------------
+
+import os
+import shutil
+import tempfile
+import unittest
+
+import numpy as np
+
+import nest
+
+nest.Install("modmodule")
+
+# time in ms, modulation; no sample falls on a trigger
+SAMPLES = [(0.0, 0.1), (25.0, 0.5), (55.0, 0.9)]
+
+
+class ModulationReplayTestCase(unittest.TestCase):
+
+    def setUp(self):
+        nest.ResetKernel()
+        nest.SetKernelStatus({"resolution": 0.1, "local_num_threads": 2})
+        self.tmpdir = tempfile.mkdtemp()
+
+    def tearDown(self):
+        shutil.rmtree(self.tmpdir)
+
+    def replay(self, filename, file_format):
+        replay = nest.Create("modulation_replay", params={
+            "filename": filename, "file_format": file_format, "deliver_interval": 10})
+
+        nest.SetDefaults("modulatory_synapse", {"vt": replay[0]})
+        pre = nest.Create("iaf_psc_exp", 2)
+        post = nest.Create("iaf_psc_exp", 2)
+        nest.Connect(pre, post, conn_spec={"rule": "all_to_all"},
+                syn_spec={"model": "modulatory_synapse", "weight_baseline": 2.0})
+        conns = nest.GetConnections(synapse_model="modulatory_synapse")
+
+        # each trigger holds the last sample at or before it
+        for t, modulation in [(20.0, 0.1), (30.0, 0.5), (50.0, 0.5), (60.0, 0.9), (80.0, 0.9)]:
+            nest.Simulate(t - nest.GetKernelStatus("time"))
+            self.assertAlmostEqual(nest.GetStatus(replay, "modulation")[0], modulation)
+            weights = np.array(nest.GetStatus(conns, "weight"))
+            self.assertTrue(np.allclose(weights, 2.0*modulation))
+
+    def test_csv(self):
+        filename = os.path.join(self.tmpdir, "modulation.csv")
+        with open(filename, "w") as f:
+            f.write("time,modulation\n")
+            for t, modulation in SAMPLES:
+                f.write("%g,%g\n" % (t, modulation))
+        self.replay(filename, "csv")
+
+    def test_binary(self):
+        filename = os.path.join(self.tmpdir, "modulation.dat")
+        np.array(SAMPLES, dtype=np.float64).tofile(filename)
+        self.replay(filename, "binary")
+
+
+if __name__ == "__main__":
+    unittest.main()
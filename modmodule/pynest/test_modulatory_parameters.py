@@ -0,0 +1,57 @@
+#----------------------------------------------------------
+# test_modulatory_parameters.py
+#
+# Sets and reads the parameters of many modulatory synapses
+# with one call and checks them against GetStatus:
+#
+#     python test_modulatory_parameters.py
+#----------------------------------------------------------
+
+import unittest
+
+import numpy as np
+
+import nest
+
+nest.Install("modmodule")
+
+
+class ModulatoryParametersTestCase(unittest.TestCase):
+
+    def setUp(self):
+        nest.ResetKernel()
+        nest.SetKernelStatus({"resolution": 0.1, "local_num_threads": 2})
+
+        vt = nest.Create("volume_transmitter")
+        nest.SetDefaults("d1_synapse", {"vt": vt[0]})
+        pre = nest.Create("iaf_psc_exp", 5)
+        post = nest.Create("iaf_psc_exp", 5)
+        nest.Connect(pre, post, conn_spec={"rule": "all_to_all"},
+                syn_spec={"model": "d1_synapse"})
+        self.conns = nest.GetConnections(synapse_model="d1_synapse")
+
+    def test_set_and_get(self):
+        for name in ["weight_baseline", "alpha", "weight"]:
+            values = np.random.uniform(0.5, 1.5, len(self.conns))
+            nest.sli_func("SetModulatoryParameters", self.conns, name, values)
+
+            # in the order of the connections, as GetStatus reads them
+            self.assertTrue(np.allclose(nest.GetStatus(self.conns, name), values))
+            self.assertTrue(np.allclose(
+                nest.sli_func("GetModulatoryParameters", self.conns, name), values))
+
+    def test_list_of_values(self):
+        values = [float(i) for i in range(len(self.conns))]
+        nest.sli_func("SetModulatoryParameters", self.conns, "weight_baseline", values)
+        self.assertTrue(np.allclose(nest.GetStatus(self.conns, "weight_baseline"), values))
+
+    def test_bad_arguments(self):
+        with self.assertRaises(nest.NESTError):
+            nest.sli_func("SetModulatoryParameters", self.conns, "weight_baseline",
+                    np.ones(len(self.conns) - 1))
+        with self.assertRaises(nest.NESTError):
+            nest.sli_func("GetModulatoryParameters", self.conns, "tau_modulation")
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,99 @@
+#----------------------------------------------------------
+# test_modulatory_stdp.py
+#
+# Drives stdp_d1_synapse and NEST's stdp_dopamine_synapse
+# with the same spike trains and volume transmitter and
+# compares what they learn, then checks the modulation of
+# the delivered weight:
+#
+#     python test_modulatory_stdp.py
+#----------------------------------------------------------
+
+import unittest
+
+import numpy as np
+
+import nest
+
+nest.Install("modmodule")
+
+STDP = {"A_plus": 1.0, "A_minus": 1.5, "tau_plus": 20.0, "tau_c": 200.0,
+        "tau_n": 100.0, "b": 0.01, "Wmin": 0.0, "Wmax": 200.0}
+
+
+def spike_times(rate, stime, seed):
+    """ Poisson spike times (ms) on the 0.1 ms grid """
+    rng = np.random.RandomState(seed)
+    t = np.unique(np.round(rng.uniform(1.0, stime, rng.poisson(rate*stime/1000.0)), 1))
+    return t.tolist()
+
+
+class ModulatoryStdpTestCase(unittest.TestCase):
+
+    def setUp(self):
+        nest.ResetKernel()
+        nest.SetKernelStatus({"resolution": 0.1, "local_num_threads": 1})
+
+        # the dopamine spikes reach the volume transmitter through a parrot
+        self.vt = nest.Create("volume_transmitter", params={"deliver_interval": 10})
+        self.dopa = nest.Create("spike_generator")
+        dopa_parrot = nest.Create("parrot_neuron")
+        nest.Connect(self.dopa, dopa_parrot)
+        nest.Connect(dopa_parrot, self.vt)
+
+    def parrot(self, times):
+        gen = nest.Create("spike_generator", params={"spike_times": times})
+        parrot = nest.Create("parrot_neuron")
+        nest.Connect(gen, parrot)
+        return parrot
+
+    def test_learning_as_stdp_dopamine_synapse(self):
+        stime = 1000.0
+        nest.SetStatus(self.dopa, {"spike_times": spike_times(20.0, stime, 3)})
+        pre = self.parrot(spike_times(20.0, stime, 1))
+        post = self.parrot(spike_times(20.0, stime, 2))
+
+        # with alpha 0 the d1 law is 1 and the synapse only learns; on port 1
+        # the parrot does not repeat the spikes, so both see the same post spikes
+        nest.SetDefaults("stdp_dopamine_synapse", dict(STDP, vt=self.vt[0]))
+        nest.SetDefaults("stdp_d1_synapse", dict(STDP, vt=self.vt[0]))
+        nest.Connect(pre, post, syn_spec={"model": "stdp_dopamine_synapse",
+            "weight": 10.0, "receptor_type": 1})
+        nest.Connect(pre, post, syn_spec={"model": "stdp_d1_synapse",
+            "weight": 10.0, "alpha": 0.0, "receptor_type": 1})
+
+        for _ in range(10):
+            nest.Simulate(stime/10)
+            reference = nest.GetStatus(nest.GetConnections(
+                synapse_model="stdp_dopamine_synapse"), ["weight", "c", "n"])[0]
+            fused = nest.GetStatus(nest.GetConnections(
+                synapse_model="stdp_d1_synapse"), ["weight", "c", "n"])[0]
+            self.assertTrue(np.allclose(fused, reference, rtol=1e-10, atol=1e-12))
+
+        # the spikes did change the weight
+        self.assertNotAlmostEqual(reference[0], 10.0)
+
+    def test_modulated_delivery(self):
+        # dopamine in the first interval, one presynaptic spike in the second
+        nest.SetStatus(self.dopa, {"spike_times": [2.0, 4.0, 6.0]})
+        pre = self.parrot([15.0])
+
+        # no learning: the target integrates the delivered weight without leak
+        post = nest.Create("iaf_psc_delta", params={"E_L": 0.0, "V_m": 0.0,
+            "V_reset": 0.0, "V_th": 1e9, "tau_m": 1e9})
+        nest.SetDefaults("stdp_d1_synapse", dict(STDP, vt=self.vt[0],
+            A_plus=0.0, A_minus=0.0, max_modulation=1))
+        nest.Connect(pre, post, syn_spec={"model": "stdp_d1_synapse",
+            "weight": 2.0, "alpha": 0.5})
+        rec = nest.Create("modulation_recorder", params={"vt": self.vt[0]})
+        nest.Simulate(30.0)
+
+        events = nest.GetStatus(rec, "events")[0]
+        modulation = events["modulation"][list(events["times"]).index(10.0)]
+        self.assertTrue(modulation > 0)
+        self.assertEqual(nest.GetStatus(nest.GetConnections(pre, post), "weight")[0], 2.0)
+        self.assertAlmostEqual(nest.GetStatus(post, "V_m")[0], 2.0*(1 + 0.5*modulation), places=6)
+
+
+if __name__ == "__main__":
+    unittest.main()